@@ -1,10 +1,13 @@
 #!/bin/sh -xe
 
+# Pass OFF to build without OpenMP, so that the tests run on one thread.
+ENABLE_OPENMP="${1:-ON}"
+
 mkdir build
 cd build
 cmake \
   -DCMAKE_BUILD_TYPE="Debug" \
-  -DENABLE_OPENMP="ON" \
+  -DENABLE_OPENMP="${ENABLE_OPENMP}" \
   -DENABLE_SANITIZERS="ON" \
   ..
 make -j$(nproc) VERBOSE=1
@@ -39,6 +39,24 @@ static bool RunBenchmark(std::function<void()> setupFn, std::function<bool()> be
   return true;
 }
 
+// A wavy square sheet of roughly n triangles, for benchmarking the kd-tree.
+static void MakeBenchmarkMesh(SMesh *m, int n) {
+  int k = std::max(1, (int)sqrt(n / 2.0));
+  double s = 100.0 / k;
+  auto at = [&](int i, int j) {
+    double x = i * s, y = j * s;
+    return Vector::From(x, y, 5 * sin(x * 0.1) * cos(y * 0.13));
+  };
+
+  STriMeta meta = {};
+  for (int i = 0; i < k; i++) {
+    for (int j = 0; j < k; j++) {
+      m->AddTriangle(meta, at(i, j), at(i + 1, j), at(i + 1, j + 1));
+      m->AddTriangle(meta, at(i, j), at(i + 1, j + 1), at(i, j + 1));
+    }
+  }
+}
+
 int main(int argc, char **argv) {
   std::vector<std::string> args = Platform::InitCli(argc, argv);
 
@@ -49,7 +67,8 @@ int main(int argc, char **argv) {
     filename = Platform::Path::From(args[2]);
   } else {
     fprintf(stderr, "Usage: %s [mode] [filename]\n", args[0].c_str());
-    fprintf(stderr, "Mode can be one of: load.\n");
+    fprintf(stderr, "Mode can be one of: load, kdtree.\n");
+    fprintf(stderr, "For kdtree, give a triangle count instead of a filename.\n");
     return 1;
   }
 
@@ -66,6 +85,27 @@ int main(int argc, char **argv) {
                             SK.Clear();
                             SS.Clear();
                           });
+  } else if (mode == "kdtree") {
+    SMesh mesh = {};
+    MakeBenchmarkMesh(&mesh, atoi(args[2].c_str()));
+    result = RunBenchmark([] {},
+                          [&] {
+                            SKdNode *root = SKdNode::From(&mesh);
+                            // Then some hidden line removal, along lines
+                            // across the sheet.
+                            for (int i = 0; i < 1000; i++) {
+                              SEdge e = {};
+                              e.a = Vector::From(i * 0.1, 0, 10);
+                              e.b = Vector::From(100 - i * 0.1, 100, 10);
+                              SEdgeList el = {};
+                              el.AddEdge(e.a, e.b);
+                              root->OcclusionTestLine(e, &el);
+                              el.Clear();
+                            }
+                            return true;
+                          },
+                          [] { Platform::FreeAllTemporary(); });
+    mesh.Clear();
   } else {
     fprintf(stderr, "Unknown mode \"%s\"\n", mode.c_str());
   }
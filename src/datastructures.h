@@ -8,6 +8,7 @@
 
 #include "solvespace.h"
 
+#include <atomic>
 #include <type_traits>
 #include <vector>
 
@@ -198,6 +199,13 @@ struct CompareId {
   const IdList<T, H> *idlist;
 };
 
+// Every time that any IdList gains or loses elements it gets a new version
+// number, so that an index built over a list can tell when it's stale.
+inline uint64_t NextIdListVersion () {
+  static std::atomic<uint64_t> version (0);
+  return ++version;
+}
+
 // A list, where each element has an integer identifier. The list is kept
 // sorted by that identifier, and items can be looked up in log n time by
 // id.
@@ -207,9 +215,13 @@ class IdList {
   std::vector<int> elemidx;
   std::vector<int> freelist;
 
+  void Touch () { version = NextIdListVersion (); }
+
   public:
   int n =
       0; // PAR@@@@@ make this private to see all interesting and suspicious places in SoveSpace ;-)
+  // Changes whenever elements are added or removed
+  uint64_t version = 0;
 
   friend struct CompareId<T, H>;
   using Compare = CompareId<T, H>;
@@ -281,6 +293,7 @@ private:
     elemstore.push_back (*t);
     elemidx.push_back (elemstore.size () - 1);
     ++n;
+    Touch ();
 
     return t->h;
   }
@@ -321,6 +334,7 @@ private:
     }
 
     ++n;
+    Touch ();
   }
 
   T *FindById (H h) {
@@ -344,6 +358,12 @@ private:
     }
   }
 
+  // The position of the first element whose id is not less than h
+  int LowerBound (H h) {
+    return (int)(std::lower_bound (elemidx.begin (), elemidx.end (), h, Compare (this)) -
+                 elemidx.begin ());
+  }
+
   T &Get (size_t i) { return elemstore[elemidx[i]]; }
   T &operator[] (size_t i) { return Get (i); }
 
@@ -382,6 +402,7 @@ private:
     }
     n = dest;
     elemidx.resize (n); // Clear left over elements at the end.
+    Touch ();
   }
   void RemoveById (H h) { // PAR@@@@@ this can be optimized
     ClearTags ();
@@ -395,6 +416,8 @@ private:
     std::swap (l->elemidx, elemidx);
     std::swap (l->freelist, freelist);
     std::swap (l->n, n);
+    Touch ();
+    l->Touch ();
   }
 
   void DeepCopyInto (IdList<T, H> *l) {
@@ -409,6 +432,7 @@ private:
     }
 
     l->n = n;
+    l->Touch ();
   }
 
   void Clear () {
@@ -420,6 +444,7 @@ private:
     elemidx.clear ();
     elemstore.clear ();
     n = 0;
+    Touch ();
   }
 };
 
@@ -205,9 +205,15 @@ Expr *ExprQuaternion::Magnitude() const {
 }
 
 Expr *Expr::From(hParam p) {
+  Expr n;
+  n.op = Op::PARAM;
+  n.a = NULL;
+  n.parh = p;
+  if (ExprDag::active)
+    return ExprDag::active->Intern(n);
+
   Expr *r = AllocExpr();
-  r->op = Op::PARAM;
-  r->parh = p;
+  *r = n;
   return r;
 }
 
@@ -241,6 +247,9 @@ Expr *Expr::From(double v) {
     return &mhalf;
   }
 
+  if (ExprDag::active)
+    return ExprDag::active->Intern(Expr(v));
+
   Expr *r = AllocExpr();
   r->op = Op::CONSTANT;
   r->v = v;
@@ -248,10 +257,15 @@ Expr *Expr::From(double v) {
 }
 
 Expr *Expr::AnyOp(Op newOp, Expr *b) {
+  Expr n;
+  n.op = newOp;
+  n.a = this;
+  n.b = b;
+  if (ExprDag::active)
+    return ExprDag::active->Intern(n);
+
   Expr *r = AllocExpr();
-  r->op = newOp;
-  r->a = this;
-  r->b = b;
+  *r = n;
   return r;
 }
 
@@ -300,7 +314,15 @@ Expr *Expr::DeepCopy() const {
 
 Expr *Expr::DeepCopyWithParamsAsPointers(IdList<Param, hParam> *firstTry,
                                          IdList<Param, hParam> *thenTry) const {
-  Expr *n = AllocExpr();
+  // When hash-consing, the memo assumes that firstTry and thenTry don't
+  // change while the table is active.
+  ExprDag *dag = ExprDag::active;
+  if (dag) {
+    if (Expr *r = dag->FindMemo(ExprDag::Memo::PARAMS_AS_POINTERS, this))
+      return r;
+  }
+
+  Expr n = *this;
   if (op == Op::PARAM) {
     // A param that is referenced by its hParam gets rewritten to go
     // straight in to the parameter table with a pointer, or simply
@@ -309,22 +331,28 @@ Expr *Expr::DeepCopyWithParamsAsPointers(IdList<Param, hParam> *firstTry,
     if (!p)
       p = thenTry->FindById(parh);
     if (p->known) {
-      n->op = Op::CONSTANT;
-      n->v = p->val;
+      n.op = Op::CONSTANT;
+      n.v = p->val;
     } else {
-      n->op = Op::PARAM_PTR;
-      n->parp = p;
+      n.op = Op::PARAM_PTR;
+      n.parp = p;
     }
-    return n;
+  } else {
+    int c = n.Children();
+    if (c > 0)
+      n.a = a->DeepCopyWithParamsAsPointers(firstTry, thenTry);
+    if (c > 1)
+      n.b = b->DeepCopyWithParamsAsPointers(firstTry, thenTry);
   }
 
-  *n = *this;
-  int c = n->Children();
-  if (c > 0)
-    n->a = a->DeepCopyWithParamsAsPointers(firstTry, thenTry);
-  if (c > 1)
-    n->b = b->DeepCopyWithParamsAsPointers(firstTry, thenTry);
-  return n;
+  if (dag) {
+    Expr *r = dag->Intern(n);
+    dag->AddMemo(ExprDag::Memo::PARAMS_AS_POINTERS, this, 0, r);
+    return r;
+  }
+  Expr *r = AllocExpr();
+  *r = n;
+  return r;
 }
 
 double Expr::Eval() const {
@@ -355,6 +383,18 @@ double Expr::Eval() const {
 }
 
 Expr *Expr::PartialWrt(hParam p) const {
+  ExprDag *dag = ExprDag::active;
+  if (dag) {
+    if (Expr *r = dag->FindMemo(ExprDag::Memo::PARTIAL, this, p.v))
+      return r;
+    Expr *r = PartialWrtUncached(p);
+    dag->AddMemo(ExprDag::Memo::PARTIAL, this, p.v, r);
+    return r;
+  }
+  return PartialWrtUncached(p);
+}
+
+Expr *Expr::PartialWrtUncached(hParam p) const {
   Expr *da, *db;
 
   switch (op) {
@@ -437,8 +477,14 @@ bool Expr::IsZeroConst() const {
 }
 
 Expr *Expr::FoldConstants() {
-  Expr *n = AllocExpr();
-  *n = *this;
+  ExprDag *dag = ExprDag::active;
+  if (dag) {
+    if (Expr *r = dag->FindMemo(ExprDag::Memo::FOLD, this))
+      return r;
+  }
+
+  Expr  folded = *this;
+  Expr *n = &folded;
 
   int c = Children();
   if (c >= 1)
@@ -509,7 +555,15 @@ Expr *Expr::FoldConstants() {
     }
     break;
   }
-  return n;
+
+  if (dag) {
+    Expr *r = dag->Intern(folded);
+    dag->AddMemo(ExprDag::Memo::FOLD, this, 0, r);
+    return r;
+  }
+  Expr *r = AllocExpr();
+  *r = folded;
+  return r;
 }
 
 void Expr::Substitute(hParam oldh, hParam newh) {
@@ -564,6 +618,156 @@ hParam Expr::ReferencedParams(ParamList *pl) const {
     ssassert(false, "Unexpected children count");
 }
 
+static size_t HashCombine(size_t h, size_t v) {
+  return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+//-----------------------------------------------------------------------------
+// Hash-consing, so that identical subexpressions are built only once.
+//-----------------------------------------------------------------------------
+thread_local ExprDag *ExprDag::active = NULL;
+
+size_t ExprDag::KeyHash::operator() (const Key &k) const {
+  size_t h = std::hash<uint64_t>{}(k.bits);
+  h = HashCombine(h, (size_t)k.op);
+  h = HashCombine(h, std::hash<uintptr_t>{}(k.a));
+  h = HashCombine(h, std::hash<uintptr_t>{}(k.b));
+  return h;
+}
+
+size_t ExprDag::MemoKeyHash::operator() (const MemoKey &k) const {
+  size_t h = std::hash<const Expr *>{}(k.e);
+  h = HashCombine(h, (size_t)k.what);
+  h = HashCombine(h, k.arg);
+  return h;
+}
+
+Expr *ExprDag::Intern(const Expr &e) {
+  Key key = {e.op, 0, 0, 0};
+  switch (e.op) {
+  case Expr::Op::PARAM: key.bits = e.parh.v; break;
+  case Expr::Op::PARAM_PTR: key.bits = (uintptr_t)e.parp; break;
+  case Expr::Op::CONSTANT: memcpy(&key.bits, &e.v, sizeof(double)); break;
+  case Expr::Op::VARIABLE: break;
+
+  default:
+    key.a = (uintptr_t)e.a;
+    if (e.Children() > 1)
+      key.b = (uintptr_t)e.b;
+    break;
+  }
+
+  stats.requested++;
+  Expr *&r = nodes[key];
+  if (r == NULL) {
+    r = Expr::AllocExpr();
+    *r = e;
+    stats.created++;
+  }
+  return r;
+}
+
+Expr *ExprDag::FindMemo(Memo what, const Expr *e, uint32_t arg) const {
+  auto it = memo.find({what, arg, e});
+  return (it == memo.end()) ? NULL : it->second;
+}
+
+void ExprDag::AddMemo(Memo what, const Expr *e, uint32_t arg, Expr *result) {
+  memo[{what, arg, e}] = result;
+}
+
+//-----------------------------------------------------------------------------
+// Compile expressions into a flat tape, and evaluate it.
+//-----------------------------------------------------------------------------
+size_t ExprTape::KeyHash::operator() (const Key &k) const {
+  size_t h = std::hash<uint64_t>{}(k.bits);
+  h = HashCombine(h, (size_t)k.op);
+  h = HashCombine(h, k.a);
+  h = HashCombine(h, k.b);
+  return h;
+}
+
+void ExprTape::Clear() {
+  code.clear();
+  reg.clear();
+  compiled.clear();
+  unique.clear();
+}
+
+uint32_t ExprTape::Add(const Expr *e) {
+  // The same node is often reachable along several paths (PartialWrt reuses
+  // the subtrees of its argument), so don't walk it twice.
+  auto it = compiled.find(e);
+  if (it != compiled.end())
+    return it->second;
+
+  Instr in = {};
+  in.op = e->op;
+  Key key = {e->op, 0, 0, 0};
+  switch (e->op) {
+  case Expr::Op::PARAM:
+    in.parh = e->parh;
+    key.bits = e->parh.v;
+    break;
+  case Expr::Op::PARAM_PTR:
+    in.parp = e->parp;
+    key.bits = (uintptr_t)e->parp;
+    break;
+  case Expr::Op::CONSTANT:
+    in.v = e->v;
+    memcpy(&key.bits, &e->v, sizeof(double));
+    break;
+  case Expr::Op::VARIABLE: ssassert(false, "Not supported yet");
+
+  default:
+    in.a = key.a = Add(e->a);
+    if (e->Children() > 1)
+      in.b = key.b = Add(e->b);
+    break;
+  }
+
+  uint32_t r;
+  auto uit = unique.find(key);
+  if (uit != unique.end()) {
+    r = uit->second;
+  } else {
+    r = (uint32_t)code.size();
+    code.push_back(in);
+    reg.push_back(in.op == Expr::Op::CONSTANT ? in.v : 0.0);
+    unique[key] = r;
+  }
+  compiled[e] = r;
+  return r;
+}
+
+void ExprTape::Eval() {
+  double *r = reg.data();
+  const size_t n = code.size();
+  for (size_t i = 0; i < n; i++) {
+    const Instr &in = code[i];
+    switch (in.op) {
+    case Expr::Op::PARAM: r[i] = SK.GetParam(in.parh)->val; break;
+    case Expr::Op::PARAM_PTR: r[i] = in.parp->val; break;
+
+    case Expr::Op::CONSTANT: break;
+    case Expr::Op::VARIABLE: ssassert(false, "Not supported yet");
+
+    case Expr::Op::PLUS: r[i] = r[in.a] + r[in.b]; break;
+    case Expr::Op::MINUS: r[i] = r[in.a] - r[in.b]; break;
+    case Expr::Op::TIMES: r[i] = r[in.a] * r[in.b]; break;
+    case Expr::Op::DIV: r[i] = r[in.a] / r[in.b]; break;
+
+    case Expr::Op::NEGATE: r[i] = -r[in.a]; break;
+    case Expr::Op::SQRT: r[i] = sqrt(r[in.a]); break;
+    case Expr::Op::SQUARE: r[i] = r[in.a] * r[in.a]; break;
+    case Expr::Op::SIN: r[i] = sin(r[in.a]); break;
+    case Expr::Op::COS: r[i] = cos(r[in.a]); break;
+    case Expr::Op::ACOS: r[i] = acos(r[in.a]); break;
+    case Expr::Op::ASIN: r[i] = asin(r[in.a]); break;
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 // Routines to pretty-print an expression. Mostly for debugging.
 //-----------------------------------------------------------------------------
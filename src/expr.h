@@ -66,6 +66,7 @@ class Expr {
   inline Expr *ACos () { return AnyOp (Op::ACOS, NULL); }
 
   Expr       *PartialWrt (hParam p) const;
+  Expr       *PartialWrtUncached (hParam p) const;
   double      Eval () const;
   void        ParamsUsedList (std::vector<hParam> *list) const;
   bool        DependsOn (hParam p) const;
@@ -98,6 +99,111 @@ class Expr {
   static Expr *From (const std::string &input, bool popUpError);
 };
 
+// A table of hash-consed expressions. While one is active on the current
+// thread, every node built by AnyOp, From, FoldConstants, PartialWrt and
+// DeepCopyWithParamsAsPointers is looked up here first, so structurally
+// identical subexpressions become a single node and the result is a DAG
+// rather than a tree. The nodes live in temporary memory, so the table must
+// not outlive the next FreeAllTemporary().
+class ExprDag {
+  public:
+  struct Stats {
+    size_t requested; // nodes that would have been allocated as a tree
+    size_t created;   // distinct nodes actually allocated
+  };
+  Stats stats = {};
+
+  static thread_local ExprDag *active;
+
+  // Makes a table active for the lifetime of the scope; NULL turns
+  // hash-consing off.
+  class Scope {
+public:
+    ExprDag *prev;
+    Scope (ExprDag *dag) : prev (active) { active = dag; }
+    ~Scope () { active = prev; }
+  };
+
+  Expr *Intern (const Expr &e);
+
+  // Memoized results of the recursive transformations, since a DAG would
+  // otherwise be walked once per path through it.
+  enum class Memo : uint32_t { FOLD = 0, PARTIAL = 1, PARAMS_AS_POINTERS = 2 };
+  Expr *FindMemo (Memo what, const Expr *e, uint32_t arg = 0) const;
+  void  AddMemo (Memo what, const Expr *e, uint32_t arg, Expr *result);
+
+  private:
+  struct Key {
+    Expr::Op  op;
+    uintptr_t a, b;
+    uint64_t  bits;
+
+    bool operator== (const Key &k) const {
+      return op == k.op && a == k.a && b == k.b && bits == k.bits;
+    }
+  };
+  struct KeyHash {
+    size_t operator() (const Key &k) const;
+  };
+  struct MemoKey {
+    Memo        what;
+    uint32_t    arg;
+    const Expr *e;
+
+    bool operator== (const MemoKey &k) const { return what == k.what && arg == k.arg && e == k.e; }
+  };
+  struct MemoKeyHash {
+    size_t operator() (const MemoKey &k) const;
+  };
+
+  std::unordered_map<Key, Expr *, KeyHash>         nodes;
+  std::unordered_map<MemoKey, Expr *, MemoKeyHash> memo;
+};
+
+// A set of expressions flattened into a linear, register-based tape. Every
+// instruction writes its own register, and structurally identical subtrees
+// are compiled only once, so a residual and its partial derivatives share
+// the work they have in common. Evaluating the tape is a single pass with no
+// recursion or pointer chasing, which is what the Newton loop wants.
+class ExprTape {
+  public:
+  struct Instr {
+    Expr::Op op;
+    uint32_t a, b; // operand registers
+    union {
+      double v;
+      hParam parh;
+      Param *parp;
+    };
+  };
+
+  std::vector<Instr>  code; // register i is written by code[i]
+  std::vector<double> reg;
+
+  void     Clear ();
+  uint32_t Add (const Expr *e);
+  void     Eval ();
+  double   Value (uint32_t r) const { return reg[r]; }
+  size_t   Size () const { return code.size (); }
+
+  private:
+  struct Key {
+    Expr::Op op;
+    uint32_t a, b;
+    uint64_t bits;
+
+    bool operator== (const Key &k) const {
+      return op == k.op && a == k.a && b == k.b && bits == k.bits;
+    }
+  };
+  struct KeyHash {
+    size_t operator() (const Key &k) const;
+  };
+
+  std::unordered_map<const Expr *, uint32_t> compiled;
+  std::unordered_map<Key, uint32_t, KeyHash> unique;
+};
+
 class ExprVector {
   public:
   Expr *x, *y, *z;
@@ -337,10 +337,50 @@ bool SMesh::IsEmpty() const {
   return (l.IsEmpty());
 }
 
-uint32_t SMesh::FirstIntersectionWith(Point2d mp) const {
+// Everything about the mesh that a Boolean reads, or that gets drawn, as a
+// sequence of words passed to add.
+template<class F>
+static void ForEachContentWord(const SMesh *m, F add) {
+  auto addVector = [&](Vector v) {
+    for (double d : {v.x, v.y, v.z}) {
+      uint64_t bits;
+      memcpy(&bits, &d, sizeof(bits));
+      add(bits);
+    }
+  };
+
+  add(m->l.n);
+  for (const STriangle &tr : m->l) {
+    add(tr.meta.face);
+    add(tr.meta.color.ToPackedIntBGRA());
+    addVector(tr.a);
+    addVector(tr.b);
+    addVector(tr.c);
+    addVector(tr.an);
+    addVector(tr.bn);
+    addVector(tr.cn);
+  }
+}
+
+uint64_t SMesh::ContentHash() const {
+  uint64_t hash = HASH_SEED;
+  ForEachContentWord(this, [&](uint64_t v) { hash = HashMix(hash, v); });
+  return hash;
+}
+
+void SMesh::ContentInto(std::vector<uint64_t> *words) const {
+  ForEachContentWord(this, [&](uint64_t v) { words->push_back(v); });
+}
+
+uint32_t SMesh::FirstIntersectionWith(Point2d mp, const STriangleBvh *bvh) const {
   Vector rayPoint = SS.GW.UnProjectPoint3(Vector::From(mp.x, mp.y, 0.0));
   Vector rayDir = SS.GW.UnProjectPoint3(Vector::From(mp.x, mp.y, 1.0)).Minus(rayPoint);
 
+  if (bvh && !bvh->IsEmpty()) {
+    int i = bvh->Raycast(this, rayPoint, rayDir, /*facesOnly=*/true);
+    return (i < 0) ? 0 : l[i].meta.face;
+  }
+
   uint32_t face = 0;
   double faceT = VERY_NEGATIVE;
   for (int i = 0; i < l.n; i++) {
@@ -361,6 +401,147 @@ uint32_t SMesh::FirstIntersectionWith(Point2d mp) const {
   return face;
 }
 
+//-----------------------------------------------------------------------------
+// A bounding volume hierarchy over the triangles of a mesh. We split at the
+// median of the triangle centroids, along the axis where those are most
+// spread out.
+//-----------------------------------------------------------------------------
+void STriangleBvh::Build(const SMesh *m) {
+  Clear();
+  if (m->l.IsEmpty())
+    return;
+
+  tri.resize(m->l.n);
+  for (int i = 0; i < m->l.n; i++) {
+    tri[i] = i;
+  }
+  node.reserve(2 * (m->l.n / LEAF_SIZE + 1));
+  BuildNode(m, 0, m->l.n);
+}
+
+int STriangleBvh::BuildNode(const SMesh *m, int first, int count) {
+  int n = (int)node.size();
+  node.emplace_back();
+
+  Vector max = Vector::From(VERY_NEGATIVE, VERY_NEGATIVE, VERY_NEGATIVE),
+         min = Vector::From(VERY_POSITIVE, VERY_POSITIVE, VERY_POSITIVE);
+  Vector cmax = max, cmin = min;
+  for (int i = first; i < first + count; i++) {
+    const STriangle &tr = m->l[tri[i]];
+    tr.a.MakeMaxMin(max, min);
+    tr.b.MakeMaxMin(max, min);
+    tr.c.MakeMaxMin(max, min);
+    (tr.a.Plus(tr.b).Plus(tr.c)).MakeMaxMin(cmax, cmin);
+  }
+  node[n].max   = max;
+  node[n].min   = min;
+  node[n].first = first;
+  node[n].count = count;
+
+  if (count <= LEAF_SIZE) {
+    node[n].left = node[n].right = -1;
+    return n;
+  }
+
+  Vector extent = cmax.Minus(cmin);
+  int axis      = 0;
+  for (int i = 1; i < 3; i++) {
+    if (extent.Element(i) > extent.Element(axis))
+      axis = i;
+  }
+
+  int half = count / 2;
+  std::nth_element(tri.begin() + first, tri.begin() + first + half, tri.begin() + first + count,
+                   [&](int a, int b) {
+                     const STriangle &ta = m->l[a], &tb = m->l[b];
+                     return ta.a.Plus(ta.b).Plus(ta.c).Element(axis) <
+                            tb.a.Plus(tb.b).Plus(tb.c).Element(axis);
+                   });
+
+  // Build the children first, since that may reallocate node.
+  int left      = BuildNode(m, first, half);
+  int right     = BuildNode(m, first + half, count - half);
+  node[n].left  = left;
+  node[n].right = right;
+  return n;
+}
+
+bool STriangleBvh::IsEmpty() const {
+  return node.empty();
+}
+
+void STriangleBvh::Clear() {
+  node.clear();
+  node.shrink_to_fit();
+  tri.clear();
+  tri.shrink_to_fit();
+}
+
+//-----------------------------------------------------------------------------
+// Of the triangles (with a nonzero face, if facesOnly) hit by the line
+// through rayPoint along rayDir, find the one with the greatest t, as
+// SMesh::FirstIntersectionWith does; on a tie, the lowest index. Returns its
+// index in the mesh, or -1 if nothing was hit.
+//-----------------------------------------------------------------------------
+int STriangleBvh::Raycast(const SMesh *m, Vector rayPoint, Vector rayDir, bool facesOnly,
+                          double *t) const {
+  int best     = -1;
+  double bestT = VERY_NEGATIVE;
+  if (IsEmpty())
+    return best;
+
+  std::vector<int> stack;
+  stack.push_back(0);
+  while (!stack.empty()) {
+    const Node &n = node[stack.back()];
+    stack.pop_back();
+
+    // The range of t over which the line lies within the box.
+    double t0 = VERY_NEGATIVE, t1 = VERY_POSITIVE;
+    bool miss = false;
+    for (int i = 0; i < 3 && !miss; i++) {
+      double o = rayPoint.Element(i), d = rayDir.Element(i);
+      double lo = n.min.Element(i) - LENGTH_EPS, hi = n.max.Element(i) + LENGTH_EPS;
+      if (d == 0.0) {
+        miss = (o < lo || o > hi);
+        continue;
+      }
+      double ta = (lo - o) / d, tb = (hi - o) / d;
+      if (ta > tb)
+        std::swap(ta, tb);
+      t0   = std::max(t0, ta);
+      t1   = std::min(t1, tb);
+      miss = (t0 > t1);
+    }
+    // Nothing in here can beat what we've already got.
+    if (miss || t1 < bestT)
+      continue;
+
+    if (n.left >= 0) {
+      stack.push_back(n.right);
+      stack.push_back(n.left);
+      continue;
+    }
+    for (int i = n.first; i < n.first + n.count; i++) {
+      const STriangle &tr = m->l[tri[i]];
+      if (facesOnly && tr.meta.face == 0)
+        continue;
+
+      SolveSpace::STriangle::Raytrace_ret eeep = tr.Raytrace(rayPoint, rayDir, false);
+      if (!eeep.hit)
+        continue;
+      if (eeep.t > bestT || (eeep.t == bestT && tri[i] < best)) {
+        best  = tri[i];
+        bestT = eeep.t;
+      }
+    }
+  }
+
+  if (t)
+    *t = bestT;
+  return best;
+}
+
 Vector SMesh::GetCenterOfMass() const {
   Vector center = Vector(0, 0, 0);
   double vol = 0.0;
@@ -380,118 +561,277 @@ SKdNode *SKdNode::Alloc() {
   return (SKdNode *)AllocTemporary(sizeof(SKdNode));
 }
 
-SKdNode *SKdNode::From(SMesh *m) {
-  int i;
-  STriangle *tra = (STriangle *)AllocTemporary((m->l.n) * sizeof(*tra));
+//-----------------------------------------------------------------------------
+// Builds a kd-tree over a set of triangles. The splitting planes are chosen
+// by the surface area heuristic, evaluated at a few bin boundaries along each
+// axis. The tree is built into flat arrays, and then laid out in temporary
+// memory as one block of nodes plus one block for the leaves' triangle lists.
+//-----------------------------------------------------------------------------
+class SKdBuilder {
+public:
+  class Box {
+  public:
+    double min[3], max[3];
+  };
+  class Node {
+  public:
+    int    which;
+    double c;
+    // The children, or -1 for a leaf.
+    int lt, gt;
+    // A leaf's triangles are leafTri[first] up to leafTri[first + count].
+    int first, count;
+  };
+  // A subtree that is still to be built, under the given node.
+  class Job {
+  public:
+    int              node;
+    std::vector<int> tris;
+    Box              region;
+    int              depth;
+  };
+
+  static const int BINS = 16;
+  static const int MAX_DEPTH = 40;
+  // Below this many triangles we build on one thread. Above it the top
+  // levels of the tree are split serially, and the subtrees beneath them
+  // are built in parallel.
+  static const int PARALLEL_MIN_TRIANGLES = 20000;
+  static const int PARALLEL_DEPTH = 4;
+  // Relative costs of visiting a node and of testing a triangle. Triangles
+  // that straddle a plane get duplicated into both children, so splitting
+  // is penalized more than usual; fewer and bigger leaves test out faster.
+  static constexpr double TRAVERSAL_COST = 4.0;
+  static constexpr double INTERSECTION_COST = 1.0;
+
+  const std::vector<STriangle *> *tri;
+  const std::vector<Box> *box;
+  std::vector<Node> node;
+  std::vector<int> leafTri;
+
+  static SKdNode *From(const std::vector<STriangle *> &tl);
+
+  bool ChooseSplit(const std::vector<int> &tris, const Box &bounds, int *which, double *c) const;
+  int Build(std::vector<int> *tris, Box region, int depth, std::vector<Job> *jobs);
+  void Graft(const Job &job, const SKdBuilder &sub);
+  SKdNode *Lay() const;
+};
+
+static int KdBin(double v, double lo, double w) {
+  int b = (int)((v - lo) / w * SKdBuilder::BINS);
+  return std::max(0, std::min(b, SKdBuilder::BINS - 1));
+}
 
-  for (i = 0; i < m->l.n; i++) {
-    tra[i] = m->l[i];
-  }
+bool SKdBuilder::ChooseSplit(const std::vector<int> &tris, const Box &bounds, int *which,
+                             double *c) const {
+  // Start from the cost of making this node a leaf.
+  double bestCost = INTERSECTION_COST * tris.size();
+  bool found = false;
 
-  srand(0);
-  int n = m->l.n;
-  while (n > 1) {
-    int k = rand() % n;
-    n--;
-    std::swap(tra[k], tra[n]);
-  }
+  for (int i = 0; i < 3; i++) {
+    double lo = bounds.min[i], w = bounds.max[i] - lo;
+    if (w < KDTREE_EPS)
+      continue;
+    // The surface area of the node's box with width x along this axis; flat
+    // boxes are thickened a little, so that the areas never vanish.
+    double d1 = std::max(bounds.max[(i + 1) % 3] - bounds.min[(i + 1) % 3], KDTREE_EPS),
+           d2 = std::max(bounds.max[(i + 2) % 3] - bounds.min[(i + 2) % 3], KDTREE_EPS);
+    auto area = [&](double x) { return 2 * (d1 * d2 + x * (d1 + d2)); };
+
+    int minBin[BINS] = {}, maxBin[BINS] = {};
+    for (int t : tris) {
+      minBin[KdBin((*box)[t].min[i], lo, w)]++;
+      maxBin[KdBin((*box)[t].max[i], lo, w)]++;
+    }
 
-  STriangleLl *tll = NULL;
-  for (i = 0; i < m->l.n; i++) {
-    STriangleLl *tn = STriangleLl::Alloc();
-    tn->tri = &(tra[i]);
-    tn->next = tll;
-    tll = tn;
+    // Sweep the planes at the boundaries between bins. A triangle goes to
+    // the lt side if it starts below the plane, and to the gt side if it
+    // ends above it; so triangles that straddle the plane go to both.
+    int nlt = 0, ngt = (int)tris.size();
+    for (int k = 1; k < BINS; k++) {
+      nlt += minBin[k - 1];
+      ngt -= maxBin[k - 1];
+      double x = w * k / BINS;
+      double cost = TRAVERSAL_COST +
+                    INTERSECTION_COST * (area(x) * nlt + area(w - x) * ngt) / area(w);
+      if (cost < bestCost) {
+        bestCost = cost;
+        *which = i;
+        *c = lo + x;
+        found = true;
+      }
+    }
   }
-
-  return SKdNode::From(tll);
+  return found;
 }
 
-SKdNode *SKdNode::From(STriangleLl *tll) {
-  int which = 0;
-  SKdNode *ret = Alloc();
+int SKdBuilder::Build(std::vector<int> *tris, Box region, int depth, std::vector<Job> *jobs) {
+  int self = (int)node.size();
+  node.push_back({});
 
-  int i;
-  int gtc[3] = {0, 0, 0}, ltc[3] = {0, 0, 0}, allc = 0;
-  double badness[3] = {0, 0, 0};
-  double split[3] = {0, 0, 0};
+  if (jobs != NULL && depth == PARALLEL_DEPTH) {
+    jobs->push_back({self, std::move(*tris), region, depth});
+    return self;
+  }
 
-  if (!tll) {
-    goto leaf;
+  // The bounds of our triangles, clipped to the space that this node covers.
+  Box bounds;
+  for (int i = 0; i < 3; i++) {
+    bounds.min[i] = VERY_POSITIVE;
+    bounds.max[i] = VERY_NEGATIVE;
+    for (int t : *tris) {
+      bounds.min[i] = std::min(bounds.min[i], (*box)[t].min[i]);
+      bounds.max[i] = std::max(bounds.max[i], (*box)[t].max[i]);
+    }
+    bounds.min[i] = std::max(bounds.min[i], region.min[i]);
+    bounds.max[i] = std::min(bounds.max[i], region.max[i]);
   }
 
-  for (i = 0; i < 3; i++) {
-    int tcnt = 0;
-    STriangleLl *ll;
-    for (ll = tll; ll; ll = ll->next) {
-      split[i] += (ll->tri->a).Element(i);
-      split[i] += (ll->tri->b).Element(i);
-      split[i] += (ll->tri->c).Element(i);
-      tcnt++;
+  int which;
+  double c;
+  if (tris->size() >= 3 && depth < MAX_DEPTH && ChooseSplit(*tris, bounds, &which, &c)) {
+    std::vector<int> ltTris, gtTris;
+    for (int t : *tris) {
+      if ((*box)[t].min[which] < c + KDTREE_EPS)
+        ltTris.push_back(t);
+      if ((*box)[t].max[which] > c - KDTREE_EPS)
+        gtTris.push_back(t);
+    }
+    // If every triangle ended up on both sides, then the split is useless.
+    if (ltTris.size() < tris->size() || gtTris.size() < tris->size()) {
+      std::vector<int>().swap(*tris);
+
+      Box ltRegion = bounds, gtRegion = bounds;
+      ltRegion.max[which] = c;
+      gtRegion.min[which] = c;
+      int lt = Build(&ltTris, ltRegion, depth + 1, jobs);
+      int gt = Build(&gtTris, gtRegion, depth + 1, jobs);
+      node[self] = {which, c, lt, gt, 0, 0};
+      return self;
     }
-    split[i] /= (tcnt * 3);
+  }
 
-    for (ll = tll; ll; ll = ll->next) {
-      STriangle *tr = ll->tri;
+  node[self] = {0, 0.0, -1, -1, (int)leafTri.size(), (int)tris->size()};
+  leafTri.insert(leafTri.end(), tris->begin(), tris->end());
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+// Attach a subtree that was built separately for job. Its root takes the
+// place of the job's node, and the rest of its nodes go at the end.
+//-----------------------------------------------------------------------------
+void SKdBuilder::Graft(const Job &job, const SKdBuilder &sub) {
+  int offset = (int)node.size() - 1, leafOffset = (int)leafTri.size();
+  auto where = [&](int i) { return (i == 0) ? job.node : offset + i; };
+
+  for (size_t i = 0; i < sub.node.size(); i++) {
+    Node n = sub.node[i];
+    if (n.lt >= 0) {
+      n.lt = where(n.lt);
+      n.gt = where(n.gt);
+    } else {
+      n.first += leafOffset;
+    }
+    if (i == 0) {
+      node[job.node] = n;
+    } else {
+      node.push_back(n);
+    }
+  }
+  leafTri.insert(leafTri.end(), sub.leafTri.begin(), sub.leafTri.end());
+}
 
-      double a = (tr->a).Element(i), b = (tr->b).Element(i), c = (tr->c).Element(i);
+SKdNode *SKdBuilder::Lay() const {
+  SKdNode *nodes = (SKdNode *)AllocTemporary(node.size() * sizeof(SKdNode));
+  STriangleLl *lls = NULL;
+  if (!leafTri.empty()) {
+    lls = (STriangleLl *)AllocTemporary(leafTri.size() * sizeof(STriangleLl));
+  }
 
-      if (a < split[i] + KDTREE_EPS || b < split[i] + KDTREE_EPS || c < split[i] + KDTREE_EPS) {
-        ltc[i]++;
-      }
-      if (a > split[i] - KDTREE_EPS || b > split[i] - KDTREE_EPS || c > split[i] - KDTREE_EPS) {
-        gtc[i]++;
+  for (size_t i = 0; i < node.size(); i++) {
+    const Node &bn = node[i];
+    SKdNode *n = &nodes[i];
+    if (bn.lt >= 0) {
+      n->which = bn.which;
+      n->c = bn.c;
+      n->lt = &nodes[bn.lt];
+      n->gt = &nodes[bn.gt];
+    } else if (bn.count > 0) {
+      // The leaf's list runs through consecutive elements, so that it stays
+      // together in memory; AddTriangle may still push more onto its head.
+      for (int k = bn.first; k < bn.first + bn.count; k++) {
+        lls[k].tri = (*tri)[leafTri[k]];
+        lls[k].next = (k + 1 < bn.first + bn.count) ? &lls[k + 1] : NULL;
       }
-      if (i == 0)
-        allc++;
+      n->tris = &lls[bn.first];
     }
-    badness[i] = pow((double)ltc[i], 4) + pow((double)gtc[i], 4);
-  }
-  if (badness[0] < badness[1] && badness[0] < badness[2]) {
-    which = 0;
-  } else if (badness[1] < badness[2]) {
-    which = 1;
-  } else {
-    which = 2;
   }
+  return &nodes[0];
+}
 
-  if (allc < 3 || allc == gtc[which] || allc == ltc[which]) {
-    goto leaf;
+SKdNode *SKdBuilder::From(const std::vector<STriangle *> &tl) {
+  int n = (int)tl.size();
+  std::vector<Box> boxes(n);
+#pragma omp parallel for if (n >= PARALLEL_MIN_TRIANGLES)
+  for (int i = 0; i < n; i++) {
+    const STriangle *tr = tl[i];
+    for (int j = 0; j < 3; j++) {
+      double a = (tr->a).Element(j), b = (tr->b).Element(j), c = (tr->c).Element(j);
+      boxes[i].min[j] = std::min(a, std::min(b, c));
+      boxes[i].max[j] = std::max(a, std::max(b, c));
+    }
   }
 
-  STriangleLl *ll;
-  STriangleLl *lgt, *llt;
-  lgt = llt = NULL;
-  for (ll = tll; ll; ll = ll->next) {
-    STriangle *tr = ll->tri;
+  SKdBuilder builder;
+  builder.tri = &tl;
+  builder.box = &boxes;
 
-    double a = (tr->a).Element(which), b = (tr->b).Element(which), c = (tr->c).Element(which);
+  std::vector<int> all(n);
+  for (int i = 0; i < n; i++) {
+    all[i] = i;
+  }
+  Box region;
+  for (int j = 0; j < 3; j++) {
+    region.min[j] = VERY_NEGATIVE;
+    region.max[j] = VERY_POSITIVE;
+  }
 
-    if (a < split[which] + KDTREE_EPS || b < split[which] + KDTREE_EPS ||
-        c < split[which] + KDTREE_EPS) {
-      STriangleLl *n = STriangleLl::Alloc();
-      *n = *ll;
-      n->next = llt;
-      llt = n;
+  if (n < PARALLEL_MIN_TRIANGLES) {
+    builder.Build(&all, region, 0, NULL);
+  } else {
+    std::vector<Job> jobs;
+    builder.Build(&all, region, 0, &jobs);
+
+    std::vector<SKdBuilder> subs(jobs.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < (int)jobs.size(); i++) {
+      subs[i].tri = &tl;
+      subs[i].box = &boxes;
+      subs[i].Build(&jobs[i].tris, jobs[i].region, jobs[i].depth, NULL);
     }
-    if (a > split[which] - KDTREE_EPS || b > split[which] - KDTREE_EPS ||
-        c > split[which] - KDTREE_EPS) {
-      STriangleLl *n = STriangleLl::Alloc();
-      *n = *ll;
-      n->next = lgt;
-      lgt = n;
+    for (size_t i = 0; i < jobs.size(); i++) {
+      builder.Graft(jobs[i], subs[i]);
     }
   }
+  return builder.Lay();
+}
 
-  ret->which = which;
-  ret->c = split[which];
-  ret->gt = SKdNode::From(lgt);
-  ret->lt = SKdNode::From(llt);
-  return ret;
+SKdNode *SKdNode::From(SMesh *m) {
+  STriangle *tra = (STriangle *)AllocTemporary((m->l.n) * sizeof(*tra));
+  std::vector<STriangle *> tl(m->l.n);
+  for (int i = 0; i < m->l.n; i++) {
+    tra[i] = m->l[i];
+    tl[i] = &tra[i];
+  }
+  return SKdBuilder::From(tl);
+}
 
-leaf:
-  ret->tris = tll;
-  return ret;
+SKdNode *SKdNode::From(STriangleLl *tll) {
+  std::vector<STriangle *> tl;
+  for (STriangleLl *ll = tll; ll; ll = ll->next) {
+    tl.push_back(ll->tri);
+  }
+  return SKdBuilder::From(tl);
 }
 
 void SKdNode::ClearTags() const {
@@ -772,29 +1112,51 @@ void SKdNode::SplitLinesAgainstTriangle(SEdgeList *sel, STriangle *tr) const {
 
 //-----------------------------------------------------------------------------
 // Given an edge orig, occlusion test it against our mesh. We output an edge
-// list in sel, where only invisible portions of the edge are tagged.
+// list in sel, where only invisible portions of the edge are tagged. This
+// doesn't modify the tree or its triangles, so many edges may be tested at
+// once.
+//-----------------------------------------------------------------------------
+void SKdNode::OcclusionTestLine(SEdge orig, SEdgeList *sel) const {
+  std::vector<STriangle *> tl;
+  ListTrianglesNearLine(orig, &tl);
+
+  // A triangle may be in several leaves, but it should split the edge only
+  // the first time that we reach it.
+  std::vector<STriangle *> seen = tl;
+  std::sort(seen.begin(), seen.end());
+  seen.erase(std::unique(seen.begin(), seen.end()), seen.end());
+  std::vector<bool> done(seen.size(), false);
+
+  for (STriangle *tr : tl) {
+    size_t i = std::lower_bound(seen.begin(), seen.end(), tr) - seen.begin();
+    if (done[i])
+      continue;
+    done[i] = true;
+
+    SplitLinesAgainstTriangle(sel, tr);
+  }
+}
+
 //-----------------------------------------------------------------------------
-void SKdNode::OcclusionTestLine(SEdge orig, SEdgeList *sel, int cnt) const {
+// List the triangles in every leaf that might occlude some part of the edge
+// orig, in the order that we reach them; a triangle appears once for each of
+// its leaves.
+//-----------------------------------------------------------------------------
+void SKdNode::ListTrianglesNearLine(SEdge orig, std::vector<STriangle *> *tl) const {
   if (gt && lt) {
     double ac = (orig.a).Element(which), bc = (orig.b).Element(which);
     // We can ignore triangles that are separated in x or y, but triangles
     // that are separated in z may still contribute
     if (ac < c + KDTREE_EPS || bc < c + KDTREE_EPS || which == 2) {
-      lt->OcclusionTestLine(orig, sel, cnt);
+      lt->ListTrianglesNearLine(orig, tl);
     }
     if (ac > c - KDTREE_EPS || bc > c - KDTREE_EPS || which == 2) {
-      gt->OcclusionTestLine(orig, sel, cnt);
+      gt->ListTrianglesNearLine(orig, tl);
     }
   } else {
     STriangleLl *ll;
     for (ll = tris; ll; ll = ll->next) {
-      STriangle *tr = ll->tri;
-
-      if (tr->tag == cnt)
-        continue;
-
-      SplitLinesAgainstTriangle(sel, tr);
-      tr->tag = cnt;
+      tl->push_back(ll->tri);
     }
   }
 }
@@ -7,6 +7,7 @@
 #include "solvespace.h"
 
 #include <iostream>
+#include <unordered_map>
 
 #include "striangle.hpp"
 
@@ -119,35 +120,106 @@ void SEdgeList::AddEdge(Vector a, Vector b, int auxA, int auxB, int tag) {
   l.Add(&e);
 }
 
-bool SEdgeList::AssembleContour(Vector first, Vector last, SContour *dest, SEdge *errorAt,
-                                bool keepDir, int start) const {
-  int i;
+//-----------------------------------------------------------------------------
+// Points get hashed into cubic cells, for finding the ones that Equal() some
+// point without comparing against all of them. The cells must be at least
+// twice LENGTH_EPS wide, so that such points span at most two cells along
+// each axis. Cells whose keys collide just share a list, which costs nothing
+// but some extra Equals() tests.
+//-----------------------------------------------------------------------------
+static constexpr double POINT_CELL = 1000 * LENGTH_EPS;
 
-  dest->AddPoint(first);
-  dest->AddPoint(last);
+static int64_t PointCellOf(double v) {
+  return (int64_t)floor(v / POINT_CELL);
+}
+static uint64_t PointCellKey(int64_t x, int64_t y, int64_t z) {
+  return ((uint64_t)x * 73856093u) ^ ((uint64_t)y * 19349663u) ^ ((uint64_t)z * 83492791u);
+}
+static uint64_t PointCellKey(Vector p) {
+  return PointCellKey(PointCellOf(p.x), PointCellOf(p.y), PointCellOf(p.z));
+}
 
-  do {
-    for (i = start; i < l.n; i++) {
-      /// @todo fix const!
-      SEdge *se = const_cast<SEdge *>(&(l[i]));
-      if (se->tag)
+// Call fn with the key of every cell that might hold a point Equal() to p.
+template<class F>
+static void ForEachPointCellNear(Vector p, F fn) {
+  int64_t x0 = PointCellOf(p.x - LENGTH_EPS), x1 = PointCellOf(p.x + LENGTH_EPS),
+          y0 = PointCellOf(p.y - LENGTH_EPS), y1 = PointCellOf(p.y + LENGTH_EPS),
+          z0 = PointCellOf(p.z - LENGTH_EPS), z1 = PointCellOf(p.z + LENGTH_EPS);
+  for (int64_t x = x0; x <= x1; x++) {
+    for (int64_t y = y0; y <= y1; y++) {
+      for (int64_t z = z0; z <= z1; z++) {
+        fn(PointCellKey(x, y, z));
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// An index of the edges' endpoints, so that assembling contours doesn't have
+// to scan the whole list for the next edge.
+//-----------------------------------------------------------------------------
+class SEdgeEndIndex {
+public:
+  // Each entry is 2 * (index of the edge) + (1 for its b end, 0 for a).
+  std::unordered_map<uint64_t, std::vector<int>> cells;
+
+  void Build(const SEdgeList *el) {
+    for (int i = 0; i < el->l.n; i++) {
+      const SEdge &se = el->l[i];
+      if (se.tag)
         continue;
+      cells[PointCellKey(se.a)].push_back(2 * i);
+      cells[PointCellKey(se.b)].push_back(2 * i + 1);
+    }
+  }
 
-      if (se->a.Equals(last)) {
-        dest->AddPoint(se->b);
-        last = se->b;
-        se->tag = 1;
-        break;
-      }
-      // Don't allow backwards edges if keepDir is true.
-      if (!keepDir && se->b.Equals(last)) {
-        dest->AddPoint(se->a);
-        last = se->a;
-        se->tag = 1;
-        break;
+  void Remove(const SEdgeList *el, int i) {
+    const SEdge &se = el->l[i];
+    for (int end = 0; end < 2; end++) {
+      std::vector<int> &cell = cells[PointCellKey(end ? se.b : se.a)];
+      auto it = std::find(cell.begin(), cell.end(), 2 * i + end);
+      if (it != cell.end()) {
+        *it = cell.back();
+        cell.pop_back();
       }
     }
-    if (i >= l.n) {
+  }
+
+  // Find the same edge that a linear scan from start would: the first
+  // untagged one with its a end at p, or (unless keepDir) its b end. Returns
+  // 2 * (index of the edge) + (1 if it's the b end), or -1 if there is none.
+  int Find(const SEdgeList *el, Vector p, bool keepDir, int start) const {
+    int best = -1;
+    ForEachPointCellNear(p, [&](uint64_t key) {
+      auto cell = cells.find(key);
+      if (cell == cells.end())
+        return;
+      for (int entry : cell->second) {
+        if (best >= 0 && entry >= best)
+          continue;
+        if (entry / 2 < start || (keepDir && (entry & 1)))
+          continue;
+        const SEdge &se = el->l[entry / 2];
+        if (se.tag)
+          continue;
+        if (((entry & 1) ? se.b : se.a).Equals(p)) {
+          best = entry;
+        }
+      }
+    });
+    return best;
+  }
+};
+
+static bool AssembleContourUsing(const SEdgeList *el, SEdgeEndIndex *index, Vector first,
+                                 Vector last, SContour *dest, SEdge *errorAt, bool keepDir,
+                                 int start) {
+  dest->AddPoint(first);
+  dest->AddPoint(last);
+
+  do {
+    int entry = index->Find(el, last, keepDir, start);
+    if (entry < 0) {
       // Couldn't assemble a closed contour; mark where.
       if (errorAt) {
         errorAt->a = first;
@@ -156,14 +228,31 @@ bool SEdgeList::AssembleContour(Vector first, Vector last, SContour *dest, SEdge
       return false;
     }
 
+    /// @todo fix const!
+    SEdge *se = const_cast<SEdge *>(&(el->l[entry / 2]));
+    // A backwards edge (only found if keepDir is false) goes from b to a.
+    last = (entry & 1) ? se->a : se->b;
+    dest->AddPoint(last);
+    se->tag = 1;
+    index->Remove(el, entry / 2);
   } while (!last.Equals(first));
 
   return true;
 }
 
+bool SEdgeList::AssembleContour(Vector first, Vector last, SContour *dest, SEdge *errorAt,
+                                bool keepDir, int start) const {
+  SEdgeEndIndex index;
+  index.Build(this);
+  return AssembleContourUsing(this, &index, first, last, dest, errorAt, keepDir, start);
+}
+
 bool SEdgeList::AssemblePolygon(SPolygon *dest, SEdge *errorAt, bool keepDir) const {
   dest->Clear();
 
+  SEdgeEndIndex index;
+  index.Build(this);
+
   bool allClosed = true;
   Vector first = Vector::From(0, 0, 0);
   Vector last = Vector::From(0, 0, 0);
@@ -174,10 +263,12 @@ bool SEdgeList::AssemblePolygon(SPolygon *dest, SEdge *errorAt, bool keepDir) co
       last = l[i].b;
       /// @todo fix const!
       const_cast<SEdge *>(&(l[i]))->tag = 1;
+      index.Remove(this, i);
       // Create a new empty contour in our polygon, and finish assembling
       // into that contour.
       dest->AddEmptyContour();
-      if (!AssembleContour(first, last, dest->l.Last(), errorAt, keepDir, i + 1)) {
+      if (!AssembleContourUsing(this, &index, first, last, dest->l.Last(), errorAt, keepDir,
+                                i + 1)) {
         allClosed = false;
       }
       // But continue assembling, even if some of the contours are open
@@ -402,31 +493,58 @@ void SEdgeList::MergeCollinearSegments(Vector a, Vector b) {
 
 void SPointList::Clear() {
   l.Clear();
+  cells.clear();
+  indexed = 0;
 }
 
-bool SPointList::ContainsPoint(Vector pt) const {
+bool SPointList::ContainsPoint(Vector pt) {
   return (IndexForPoint(pt) >= 0);
 }
 
-int SPointList::IndexForPoint(Vector pt) const {
-  int i;
-  for (i = 0; i < l.n; i++) {
-    const SPoint *p = &(l[i]);
-    if (pt.Equals(p->p)) {
-      return i;
+void SPointList::Reindex() {
+  cells.clear();
+  indexed = 0;
+}
+
+int SPointList::IndexForPoint(Vector pt) {
+  if (l.n < indexed) {
+    Reindex();
+  }
+  if (l.n < INDEX_MIN) {
+    int i;
+    for (i = 0; i < l.n; i++) {
+      const SPoint *p = &(l[i]);
+      if (pt.Equals(p->p)) {
+        return i;
+      }
     }
+    // Not found, so return negative to indicate that.
+    return -1;
   }
-  // Not found, so return negative to indicate that.
-  return -1;
-}
 
-void SPointList::IncrementTagFor(Vector pt) {
-  SPoint *p;
-  for (p = l.First(); p; p = l.NextAfter(p)) {
-    if (pt.Equals(p->p)) {
-      (p->tag)++;
+  for (; indexed < l.n; indexed++) {
+    cells[PointCellKey(l[indexed].p)].push_back(indexed);
+  }
+  // Same answer as the linear search: the first point that Equals().
+  int best = -1;
+  ForEachPointCellNear(pt, [&](uint64_t key) {
+    auto cell = cells.find(key);
+    if (cell == cells.end())
       return;
+    for (int i : cell->second) {
+      if ((best < 0 || i < best) && pt.Equals(l[i].p)) {
+        best = i;
+      }
     }
+  });
+  return best;
+}
+
+void SPointList::IncrementTagFor(Vector pt) {
+  int i = IndexForPoint(pt);
+  if (i >= 0) {
+    (l[i].tag)++;
+    return;
   }
   SPoint pa;
   pa.p = pt;
@@ -440,6 +558,11 @@ void SPointList::Add(Vector pt) {
   l.Add(&p);
 }
 
+void SPointList::RemoveTagged() {
+  l.RemoveTagged();
+  Reindex();
+}
+
 void SContour::AddPoint(Vector p) {
   SPoint sp;
   sp.tag = 0;
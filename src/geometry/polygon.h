@@ -12,6 +12,7 @@ class SPolygon;
 class SContour;
 class SMesh;
 class SBsp3;
+class STriangleBvh;
 class SOutlineList;
 
 enum class EarType : uint32_t { UNKNOWN = 0, NOT_EAR = 1, EAR = 2 };
@@ -95,11 +96,22 @@ class SPointList {
   public:
   List<SPoint> l;
 
+  // Once the list is long enough, lookups go through a hash of the points by
+  // position. Points appended to l are hashed at the next lookup, and if l
+  // has shrunk then the hash is rebuilt; but anything that removes points
+  // from l and then adds others before the next lookup must use
+  // RemoveTagged() or call Reindex().
+  static const int INDEX_MIN = 32;
+  std::unordered_map<uint64_t, std::vector<int>> cells;
+  int                                            indexed = 0;
+
   void Clear ();
-  bool ContainsPoint (Vector pt) const;
-  int  IndexForPoint (Vector pt) const;
+  bool ContainsPoint (Vector pt);
+  int  IndexForPoint (Vector pt);
   void IncrementTagFor (Vector pt);
   void Add (Vector pt);
+  void RemoveTagged ();
+  void Reindex ();
 };
 
 class SContour {
@@ -121,10 +133,7 @@ class SContour {
   void   FindPointWithMinX ();
   Vector AnyEdgeMidpoint () const;
 
-  bool IsEmptyTriangle (int ap, int bp, int cp, double scaledEPS) const;
-  bool IsEar (int bp, double scaledEps) const;
   bool BridgeToContour (SContour *sc, SEdgeList *el, List<Vector> *vl);
-  void ClipEarInto (SMesh *m, int bp, double scaledEps);
   void UvTriangulateInto (SMesh *m, SSurface *srf);
 };
 
@@ -245,14 +254,43 @@ class SMesh {
   double CalculateVolume () const;
   double CalculateSurfaceArea (const std::vector<uint32_t> &faces) const;
 
-  bool IsEmpty () const;
-  void RemapFaces (Group *g, int remap);
+  bool     IsEmpty () const;
+  void     RemapFaces (Group *g, int remap);
+  uint64_t ContentHash () const;
+  void     ContentInto (std::vector<uint64_t> *words) const;
 
-  uint32_t FirstIntersectionWith (Point2d mp) const;
+  uint32_t FirstIntersectionWith (Point2d mp, const STriangleBvh *bvh = NULL) const;
 
   Vector GetCenterOfMass () const;
 };
 
+// A bounding volume hierarchy over the triangles of a mesh, for ray queries
+// like picking. It refers to triangles by their index in the mesh, so it
+// must be rebuilt whenever the mesh changes.
+class STriangleBvh {
+  public:
+  struct Node {
+    Vector max, min;
+    // The children, or if left < 0 then a leaf with the triangles
+    // tri[first, first + count).
+    int left, right;
+    int first, count;
+  };
+
+  std::vector<Node> node;
+  std::vector<int>  tri;
+
+  static const int LEAF_SIZE = 4;
+
+  void Build (const SMesh *m);
+  int  BuildNode (const SMesh *m, int first, int count);
+  bool IsEmpty () const;
+  void Clear ();
+
+  int Raycast (const SMesh *m, Vector rayPoint, Vector rayDir, bool facesOnly,
+               double *t = NULL) const;
+};
+
 // A linked list of triangles
 class STriangleLl {
   public:
@@ -315,7 +353,8 @@ class SKdNode {
                              bool *leaky, int auxA = 0) const;
   void MakeOutlinesInto (SOutlineList *sel, EdgeKind tagKind) const;
 
-  void OcclusionTestLine (SEdge orig, SEdgeList *sel, int cnt) const;
+  void OcclusionTestLine (SEdge orig, SEdgeList *sel) const;
+  void ListTrianglesNearLine (SEdge orig, std::vector<STriangle *> *tl) const;
   void SplitLinesAgainstTriangle (SEdgeList *sel, STriangle *tr) const;
 
   void SnapToMesh (SMesh *m);
@@ -9,6 +9,8 @@
 #include "solvespace.h"
 #include "ssg.h"
 
+#include <list>
+
 const hParam Param::NO_PARAM = {0};
 #define NO_PARAM (Param::NO_PARAM)
 
@@ -27,6 +29,7 @@ void Group::Clear() {
   thisShell.Clear();
   runningShell.Clear();
   displayMesh.Clear();
+  displayMeshBvh.Clear();
   displayOutlines.Clear();
   impMesh.Clear();
   impShell.Clear();
@@ -1069,6 +1072,102 @@ void Group::GenerateForStepAndRepeat(T *steps, T *outs, Group::CombineAs forWhat
   *outs = soFar->at(0);
 }
 
+//-----------------------------------------------------------------------------
+// The results of the most recent Booleans, keyed by a hash of their operands
+// and the operation. Regenerating a group whose inputs didn't change (say
+// because the edit was in a later group) then just copies the old result.
+// Each entry keeps its operands' content too, and a hit must match that
+// exactly, so a hash collision costs only a miss.
+//-----------------------------------------------------------------------------
+static bool BooleanFailed(SShell *s) {
+  return s->booleanFailed;
+}
+static bool BooleanFailed(SMesh *) {
+  return false;
+}
+static void SetBooleanFailed(SShell *s, bool failed) {
+  s->booleanFailed = failed;
+}
+static void SetBooleanFailed(SMesh *, bool) {
+}
+
+template<class T>
+class BooleanCache {
+  public:
+  static const size_t CAPACITY = 16;
+
+  struct Entry {
+    uint64_t              key;
+    std::vector<uint64_t> operands;
+    T                     result;
+    bool                  booleanFailed;
+  };
+  // Most recently used first.
+  std::list<Entry> entries;
+
+  bool Find(uint64_t key, const std::vector<uint64_t> &operands, T *outs) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      if (it->key != key || it->operands != operands)
+        continue;
+      entries.splice(entries.begin(), entries, it);
+      outs->MakeFromCopyOf(&entries.front().result);
+      SetBooleanFailed(outs, entries.front().booleanFailed);
+      return true;
+    }
+    return false;
+  }
+
+  void Add(uint64_t key, std::vector<uint64_t> &&operands, T *outs) {
+    if (entries.size() >= CAPACITY) {
+      entries.back().result.Clear();
+      entries.pop_back();
+    }
+    entries.push_front({key, std::move(operands), {}, BooleanFailed(outs)});
+    entries.front().result.MakeFromCopyOf(outs);
+  }
+
+  void Clear() {
+    for (Entry &e : entries) {
+      e.result.Clear();
+    }
+    entries.clear();
+  }
+};
+
+template<class T>
+static BooleanCache<T> *GetBooleanCache() {
+  static BooleanCache<T> cache;
+  return &cache;
+}
+
+// Everything that a Boolean's result depends on, as words: both operands,
+// the operation, and the chord tolerance, which the piecewise linear curves
+// and the subdivision depend on.
+template<class T>
+static void BooleanOperandsInto(T *prevs, T *thiss, Group::CombineAs how,
+                                std::vector<uint64_t> *words) {
+  prevs->ContentInto(words);
+  thiss->ContentInto(words);
+  words->push_back((uint64_t)how);
+  double chordTol = SS.ChordTolMm();
+  uint64_t bits;
+  memcpy(&bits, &chordTol, sizeof(bits));
+  words->push_back(bits);
+}
+
+static uint64_t BooleanCacheKey(const std::vector<uint64_t> &operands) {
+  uint64_t key = HASH_SEED;
+  for (uint64_t v : operands) {
+    key = HashMix(key, v);
+  }
+  return key;
+}
+
+void Group::ClearBooleanCache() {
+  GetBooleanCache<SShell>()->Clear();
+  GetBooleanCache<SMesh>()->Clear();
+}
+
 template<class T>
 void Group::GenerateForBoolean(T *prevs, T *thiss, T *outs, Group::CombineAs how) {
   // If this group contributes no new mesh, then our running mesh is the
@@ -1079,6 +1178,16 @@ void Group::GenerateForBoolean(T *prevs, T *thiss, T *outs, Group::CombineAs how
     return;
   }
 
+  // If we've recently combined the same two shells the same way, then the
+  // result is the same too.
+  BooleanCache<T> *cache = GetBooleanCache<T>();
+  std::vector<uint64_t> operands;
+  BooleanOperandsInto(prevs, thiss, how, &operands);
+  uint64_t key = BooleanCacheKey(operands);
+  if (cache->Find(key, operands, outs)) {
+    return;
+  }
+
   // So our group's shell appears in thisShell. Combine this with the
   // previous group's shell, using the requested operation.
   switch (how) {
@@ -1090,6 +1199,7 @@ void Group::GenerateForBoolean(T *prevs, T *thiss, T *outs, Group::CombineAs how
 
   case CombineAs::ASSEMBLE: outs->MakeFromAssemblyOf(prevs, thiss); break;
   }
+  cache->Add(key, std::move(operands), outs);
 }
 
 void Group::GenerateShellAndMesh() {
@@ -1337,6 +1447,8 @@ void Group::GenerateDisplayItems() {
   // to find the emphasized edges for a mesh), so we will run it only
   // if its inputs have changed.
   if (displayDirty) {
+    displayMeshBvh.Clear();
+
     Group *pg = RunningMeshGroup();
     if (pg && thisMesh.IsEmpty() && thisShell.IsEmpty()) {
       // We don't contribute any new solid model in this group, so our
@@ -1435,6 +1547,17 @@ bool Group::IsMeshGroup() {
   }
 }
 
+//-----------------------------------------------------------------------------
+// The hierarchy over displayMesh, for picking faces. It's built the first
+// time that it's needed after the display mesh changes.
+//-----------------------------------------------------------------------------
+const STriangleBvh *Group::GetDisplayMeshBvh() {
+  if (displayMeshBvh.IsEmpty()) {
+    displayMeshBvh.Build(&displayMesh);
+  }
+  return &displayMeshBvh;
+}
+
 void Group::DrawMesh(DrawMeshAs how, Canvas *canvas) {
   if (!(SS.GW.showShaded || SS.GW.drawOccludedAs != GraphicsWindow::DrawOccludedAs::VISIBLE))
     return;
@@ -102,6 +102,7 @@ class Group {
 
   bool         displayDirty;
   SMesh        displayMesh;
+  STriangleBvh displayMeshBvh; // built on first use, see GetDisplayMeshBvh
   SOutlineList displayOutlines;
 
   enum class CombineAs : uint32_t { UNION = 0, DIFFERENCE = 1, ASSEMBLE = 2, INTERSECTION = 3 };
@@ -178,6 +179,8 @@ class Group {
   template<class T>
   void GenerateForBoolean (T *a, T *b, T *o, Group::CombineAs how);
   void GenerateDisplayItems ();
+  const STriangleBvh *GetDisplayMeshBvh ();
+  static void ClearBooleanCache ();
 
   enum class DrawMeshAs { DEFAULT, HOVERED, SELECTED };
   void DrawMesh (DrawMeshAs how, Canvas *canvas);
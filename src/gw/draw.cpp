@@ -422,6 +422,148 @@ GraphicsWindow::Selection GraphicsWindow::ChooseFromHoverToDrag() {
   return sel;
 }
 
+static int HoverGridCell(double v, double min, double w, int n) {
+  int c = (int)floor((v - min) / w);
+  return std::max(0, std::min(c, n - 1));
+}
+
+//-----------------------------------------------------------------------------
+// Bucket the bounding boxes of the items at the given positions, which must
+// be in order, into a uniform grid. The boxes and the unbounded items are
+// filled in by the caller.
+//-----------------------------------------------------------------------------
+void GraphicsWindow::HoverGrid::Buckets::Build(const std::vector<int> &bounded) {
+  cellStart.clear();
+  cellItem.clear();
+
+  BBox all = {};
+  for (size_t k = 0; k < bounded.size(); k++) {
+    const BBox &bb = bbox[bounded[k]];
+    if (k == 0) {
+      all = bb;
+    } else {
+      all.Include(bb.minp);
+      all.Include(bb.maxp);
+    }
+  }
+
+  int side = (int)ceil(sqrt((double)bounded.size()));
+  if (side > MAX_CELLS)
+    side = MAX_CELLS;
+  nx = ny = std::max(1, side);
+  minx = all.minp.x;
+  miny = all.minp.y;
+  cellw = std::max((all.maxp.x - minx) / nx, LENGTH_EPS);
+  cellh = std::max((all.maxp.y - miny) / ny, LENGTH_EPS);
+
+  // Count the entries in each cell, then fill them in; going through the
+  // items in order keeps every cell sorted by position in the list.
+  cellStart.assign(nx * ny + 1, 0);
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<int> fill;
+    if (pass == 1) {
+      for (int c = 0; c < nx * ny; c++) {
+        cellStart[c + 1] += cellStart[c];
+      }
+      cellItem.resize(cellStart[nx * ny]);
+      fill.assign(cellStart.begin(), cellStart.end() - 1);
+    }
+    for (int i : bounded) {
+      int x0 = HoverGridCell(bbox[i].minp.x, minx, cellw, nx),
+          x1 = HoverGridCell(bbox[i].maxp.x, minx, cellw, nx),
+          y0 = HoverGridCell(bbox[i].minp.y, miny, cellh, ny),
+          y1 = HoverGridCell(bbox[i].maxp.y, miny, cellh, ny);
+      for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+          int c = y * nx + x;
+          if (pass == 0) {
+            cellStart[c + 1]++;
+          } else {
+            cellItem[fill[c]++] = i;
+          }
+        }
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Return, in list order, the items that might be drawn within r pixels of
+// the point p.
+//-----------------------------------------------------------------------------
+void GraphicsWindow::HoverGrid::Buckets::CandidatesNear(Point2d p, double r,
+                                                        std::vector<int> *l) const {
+  *l = unbounded;
+  if (!cellStart.empty()) {
+    int x0 = HoverGridCell(p.x - r, minx, cellw, nx), x1 = HoverGridCell(p.x + r, minx, cellw, nx),
+        y0 = HoverGridCell(p.y - r, miny, cellh, ny), y1 = HoverGridCell(p.y + r, miny, cellh, ny);
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        int c = y * nx + x;
+        for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+          int i = cellItem[k];
+          if (bbox[i].Contains(p, r))
+            l->push_back(i);
+        }
+      }
+    }
+  }
+  std::sort(l->begin(), l->end());
+  l->erase(std::unique(l->begin(), l->end()), l->end());
+}
+
+//-----------------------------------------------------------------------------
+// Bucket every entity's screen bounding box. Entities without a usable box
+// are kept aside, to be picked wherever the cursor is.
+//-----------------------------------------------------------------------------
+void GraphicsWindow::HoverGrid::Build() {
+  entities.bbox.assign(SK.entity.n, BBox());
+  entities.unbounded.clear();
+
+  std::vector<int> bounded;
+  for (int i = 0; i < SK.entity.n; i++) {
+    Entity &e = SK.entity[i];
+    bool hasBBox;
+    BBox bb = e.GetOrGenerateScreenBBox(&hasBBox);
+    // A normal's box is just its point and not the arrow that we draw, and
+    // exploded entities get drawn away from where they're bounded.
+    if (!hasBBox || e.IsNormal() || e.ShouldDrawExploded()) {
+      entities.unbounded.push_back(i);
+      continue;
+    }
+    entities.bbox[i] = bb;
+    bounded.push_back(i);
+  }
+  entities.Build(bounded);
+}
+
+//-----------------------------------------------------------------------------
+// Bucket every constraint's screen bounding box, found by drawing it once.
+// It's drawn as hovered, which lays it out the same as by default but even
+// if it's hidden, so that showing it doesn't make its box stale.
+//-----------------------------------------------------------------------------
+void GraphicsWindow::HoverGrid::BuildConstraints(const Camera &camera) {
+  constraints.bbox.assign(SK.constraint.n, BBox());
+  constraints.unbounded.clear();
+
+  ScreenBBoxCanvas canvas = {};
+  canvas.camera = camera;
+  std::vector<int> bounded;
+  for (int i = 0; i < SK.constraint.n; i++) {
+    Constraint &c = SK.constraint[i];
+    bool hasBBox;
+    BBox bb = canvas.Collect([&] { c.Draw(Constraint::DrawAs::HOVERED, &canvas); }, &hasBBox);
+    if (!hasBBox) {
+      constraints.unbounded.push_back(i);
+      continue;
+    }
+    constraints.bbox[i] = bb;
+    bounded.push_back(i);
+  }
+  canvas.Clear();
+  constraints.Build(bounded);
+}
+
 void GraphicsWindow::HitTestMakeSelection(Point2d mp) {
   hoverList = {};
   Selection sel = {};
@@ -436,6 +578,17 @@ void GraphicsWindow::HitTestMakeSelection(Point2d mp) {
     for (Entity &e : SK.entity) {
       e.screenBBoxValid = false;
     }
+    hoverGrid.valid = false;
+    hoverGrid.constraintsValid = false;
+  }
+  // Regenerating the entities gives the list a new version, and the new
+  // entities have no screen bounding boxes yet. The constraints are drawn
+  // relative to the entities, so they've likely moved too.
+  if (!hoverGrid.valid || hoverGrid.entityVersion != SK.entity.version) {
+    hoverGrid.Build();
+    hoverGrid.valid = true;
+    hoverGrid.entityVersion = SK.entity.version;
+    hoverGrid.constraintsValid = false;
   }
 
   ObjectPicker canvas = {};
@@ -444,9 +597,21 @@ void GraphicsWindow::HitTestMakeSelection(Point2d mp) {
   canvas.point = mp;
   canvas.maxZIndex = -1;
 
+  // A stroke gets picked from up to half its width beyond the selection
+  // radius, and free points are drawn with a 14 px wide analysis stroke.
+  // The extra pixel covers alignment to the pixel grid.
+  double reach = 7.0;
+  for (Style &s : SK.style) {
+    reach = std::max(reach, Style::Width(s.h) / 2.0);
+  }
+  std::vector<int> candidates;
+  double candidateRadius = canvas.selRadius + reach + 1.0;
+  hoverGrid.entities.CandidatesNear(mp, candidateRadius, &candidates);
+
   // Always do the entities; we might be dragging something that should
   // be auto-constrained, and we need the hover for that.
-  for (Entity &e : SK.entity) {
+  for (int i : candidates) {
+    Entity &e = SK.entity[i];
     if (!e.IsVisible())
       continue;
 
@@ -484,8 +649,15 @@ void GraphicsWindow::HitTestMakeSelection(Point2d mp) {
 
   // The constraints and faces happen only when nothing's in progress.
   if (pending.operation == Pending::NONE) {
-    // Constraints
-    for (Constraint &c : SK.constraint) {
+    // Constraints; the ones new since the grid was built have no box yet.
+    if (!hoverGrid.constraintsValid || hoverGrid.constraintVersion != SK.constraint.version) {
+      hoverGrid.BuildConstraints(canvas.camera);
+      hoverGrid.constraintsValid = true;
+      hoverGrid.constraintVersion = SK.constraint.version;
+    }
+    hoverGrid.constraints.CandidatesNear(mp, candidateRadius, &candidates);
+    for (int i : candidates) {
+      Constraint &c = SK.constraint[i];
       if (canvas.Pick([&] { c.Draw(Constraint::DrawAs::DEFAULT, &canvas); })) {
         Hover hov = {};
         hov.distance = canvas.minDistance;
@@ -494,6 +666,9 @@ void GraphicsWindow::HitTestMakeSelection(Point2d mp) {
         hoverList.Add(&hov);
       }
     }
+  } else {
+    // Whatever's being dragged might be a constraint's label.
+    hoverGrid.constraintsValid = false;
   }
 
   std::sort(hoverList.begin(), hoverList.end(), [](const Hover &a, const Hover &b) {
@@ -509,7 +684,7 @@ void GraphicsWindow::HitTestMakeSelection(Point2d mp) {
       Group *g = SK.GetGroup(activeGroup);
       SMesh *m = &(g->displayMesh);
 
-      uint32_t v = m->FirstIntersectionWith(mp);
+      uint32_t v = m->FirstIntersectionWith(mp, g->GetDisplayMeshBvh());
       if (v) {
         sel.entity.v = v;
       }
@@ -727,6 +902,12 @@ void GraphicsWindow::Draw(Canvas *canvas) {
   if (showSnapGrid)
     DrawSnapGrid(canvas);
 
+  // Anything that needs the persistent geometry redrawn might also have
+  // moved the constraints.
+  if (persistentDirty) {
+    hoverGrid.constraintsValid = false;
+  }
+
   // Draw all the things that don't change when we rotate.
   if (persistentCanvas != NULL) {
     if (persistentDirty) {
@@ -194,6 +194,46 @@ public:
   };
 
   List<Hover>     hoverList;
+
+  // Uniform grids over the screen bounding boxes of the entities and of the
+  // constraints, so that hit testing only has to pick what's near the
+  // cursor. The entities' grid is rebuilt when the projection changes or the
+  // entities are regenerated; the constraints' also when the sketch is
+  // redrawn, or after anything (like a label) has been dragged.
+  class HoverGrid {
+public:
+    static const int MAX_CELLS = 64; // along each axis
+
+    class Buckets {
+  public:
+      int    nx, ny;
+      double minx, miny, cellw, cellh;
+      // Indexed by position in the list that's bucketed.
+      std::vector<BBox> bbox;
+      // The items overlapping cell c are cellItem[cellStart[c]] up to
+      // cellItem[cellStart[c + 1]], as positions in the list.
+      std::vector<int> cellStart;
+      std::vector<int> cellItem;
+      // Items that we can't bound on screen, so must always be picked.
+      std::vector<int> unbounded;
+
+      void Build (const std::vector<int> &bounded);
+      void CandidatesNear (Point2d p, double r, std::vector<int> *l) const;
+    };
+
+    bool     valid             = false;
+    bool     constraintsValid  = false;
+    uint64_t entityVersion     = 0;
+    uint64_t constraintVersion = 0;
+    // Positions in SK.entity, and in SK.constraint.
+    Buckets entities;
+    Buckets constraints;
+
+    void Build ();
+    void BuildConstraints (const Camera &camera);
+  };
+  HoverGrid hoverGrid;
+
   Selection       hover;
   bool            hoverWasSelectedOnMousedown;
   List<Selection> selection;
@@ -485,6 +485,8 @@ void GraphicsWindow::ClearPending(int which, bool scheduleShowTW) {
   pending.points.Clear();
   pending.requests.Clear();
   pending = {};
+  // Whatever was being dragged has been let go.
+  SS.EndDragSession();
   if (scheduleShowTW) {
     SS.ScheduleShowTW();
   }
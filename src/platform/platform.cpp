@@ -20,7 +20,8 @@
 #  include <sys/stat.h>
 #endif
 
-#include <list>
+#include <cstddef>
+#include <mutex>
 
 namespace SolveSpace {
   namespace Platform {
@@ -698,22 +699,144 @@ namespace SolveSpace {
     // Temporary arena.
     //-----------------------------------------------------------------------------
 
-    static thread_local std::list<void *> TempArena = {};
+    // Memory is handed out by bumping a pointer through a chain of large chunks; nothing is
+    // freed individually. FreeAllTemporary() rewinds the arena and, unless asked otherwise,
+    // keeps the standard-sized chunks around so that the next regeneration does not have to
+    // go back to malloc() at all. Each thread bumps its own arena, but since worker threads
+    // hand their temporaries back to the main one, FreeAllTemporary() rewinds all of them.
+    static const size_t TEMP_CHUNK_SIZE = 1024 * 1024;
+    static const size_t TEMP_ALIGN      = alignof(std::max_align_t);
+
+    struct TempChunk {
+      TempChunk *next;
+      size_t     capacity;
+      size_t     used;
+
+      uint8_t *Data() { return (uint8_t *)this + HeaderSize(); }
+      static size_t HeaderSize() { return (sizeof(TempChunk) + TEMP_ALIGN - 1) & ~(TEMP_ALIGN - 1); }
+    };
+
+    struct TempArena {
+      TempChunk *current  = NULL; // chunk being bumped into; the head of `used`
+      TempChunk *spare    = NULL; // retained chunks, ready for reuse
+      bool       retain   = true;
+      TemporaryArenaStats stats = {};
+
+      TempArena();
+      ~TempArena();
+
+      static void Release(TempChunk *chunk) {
+        while (chunk != NULL) {
+          TempChunk *next = chunk->next;
+          ::free(chunk);
+          chunk = next;
+        }
+      }
+
+      TempChunk *NewChunk(size_t size) {
+        size_t     capacity = std::max(size, TEMP_CHUNK_SIZE - TempChunk::HeaderSize());
+        TempChunk *chunk;
+        if (capacity == TEMP_CHUNK_SIZE - TempChunk::HeaderSize() && spare != NULL) {
+          chunk = spare;
+          spare = spare->next;
+        } else {
+          chunk = (TempChunk *)malloc(TempChunk::HeaderSize() + capacity);
+          ssassert(chunk != NULL, "out of memory");
+          chunk->capacity = capacity;
+          stats.bytesReserved += capacity;
+          stats.chunkCount++;
+        }
+        chunk->used = 0;
+        chunk->next = current;
+        current     = chunk;
+        return chunk;
+      }
+
+      void *Alloc(size_t size) {
+        size = (size + TEMP_ALIGN - 1) & ~(TEMP_ALIGN - 1);
+        TempChunk *chunk = current;
+        if (chunk == NULL || chunk->capacity - chunk->used < size) {
+          chunk = NewChunk(size);
+        }
+        void *ptr = chunk->Data() + chunk->used;
+        chunk->used += size;
+
+        stats.bytesInUse += size;
+        stats.allocationCount++;
+        if (stats.bytesInUse > stats.highWaterMark) {
+          stats.highWaterMark = stats.bytesInUse;
+        }
+        return ptr;
+      }
+
+      void Reset() {
+        while (current != NULL) {
+          TempChunk *chunk = current;
+          current          = chunk->next;
+          if (retain && chunk->capacity == TEMP_CHUNK_SIZE - TempChunk::HeaderSize()) {
+            chunk->next = spare;
+            spare       = chunk;
+          } else {
+            stats.bytesReserved -= chunk->capacity;
+            stats.chunkCount--;
+            ::free(chunk);
+          }
+        }
+        if (!retain) {
+          Release(spare);
+          stats.bytesReserved = 0;
+          stats.chunkCount    = 0;
+          spare               = NULL;
+        }
+        stats.bytesInUse      = 0;
+        stats.allocationCount = 0;
+      }
+    };
+
+    static std::mutex               TempArenasMutex;
+    static std::vector<TempArena *> TempArenas;
+    static bool                     TempArenasRetain = true;
+
+    TempArena::TempArena() {
+      std::lock_guard<std::mutex> lock(TempArenasMutex);
+      retain = TempArenasRetain;
+      TempArenas.push_back(this);
+    }
+
+    TempArena::~TempArena() {
+      {
+        std::lock_guard<std::mutex> lock(TempArenasMutex);
+        TempArenas.erase(std::find(TempArenas.begin(), TempArenas.end(), this));
+      }
+      Release(current);
+      Release(spare);
+    }
+
+    static thread_local TempArena Arena;
 
     void *AllocTemporary(size_t size) {
-      void *ptr = malloc(size);
-      ssassert(ptr != NULL, "out of memory");
+      void *ptr = Arena.Alloc(size);
       memset(ptr, 0, size);
-      TempArena.push_back(ptr);
       return ptr;
     }
 
     void FreeAllTemporary() {
-      for (void *ptr : TempArena) {
-        free(ptr);
+      std::lock_guard<std::mutex> lock(TempArenasMutex);
+      for (TempArena *arena : TempArenas) {
+        arena->Reset();
+      }
+    }
+
+    void SetTemporaryArenaRetainsChunks(bool retain) {
+      std::lock_guard<std::mutex> lock(TempArenasMutex);
+      TempArenasRetain = retain;
+      for (TempArena *arena : TempArenas) {
+        arena->retain = retain;
       }
+    }
 
-      TempArena.clear();
+    TemporaryArenaStats GetTemporaryArenaStats() {
+      return Arena.stats;
     }
 
   } // namespace Platform
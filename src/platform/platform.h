@@ -76,9 +76,24 @@ namespace SolveSpace {
     // Debug print function.
     void DebugPrint (const char *fmt, ...);
 
-    // Temporary arena functions.
+    // Temporary arena functions. Memory returned by AllocTemporary is zeroed and lives until
+    // the next FreeAllTemporary. Each thread allocates from its own arena, but
+    // FreeAllTemporary rewinds them all, so it must not be called while another thread may
+    // still be allocating.
     void *AllocTemporary (size_t size);
     void  FreeAllTemporary ();
 
+    struct TemporaryArenaStats {
+      size_t bytesInUse;      // handed out since the last FreeAllTemporary
+      size_t bytesReserved;   // held in chunks, including retained ones
+      size_t highWaterMark;   // largest bytesInUse seen so far on the calling thread
+      size_t allocationCount; // allocations since the last FreeAllTemporary
+      size_t chunkCount;
+    };
+    TemporaryArenaStats GetTemporaryArenaStats ();
+    // By default FreeAllTemporary keeps its chunks for reuse by the next generation; pass
+    // false to return them to the system instead. Applies to the arenas of all threads.
+    void SetTemporaryArenaRetainsChunks (bool retain);
+
   } // namespace Platform
 } // namespace SolveSpace
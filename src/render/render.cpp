@@ -423,4 +423,102 @@ namespace SolveSpace {
     drawFn();
     return minDistance < selRadius;
   }
+
+  //-----------------------------------------------------------------------------
+  // A canvas that bounds drawn geometry on screen.
+  //-----------------------------------------------------------------------------
+
+  void ScreenBBoxCanvas::Include(const Vector &p) {
+    Vector proj = camera.ProjectPoint3(p);
+    if (hasBBox) {
+      bbox.Include(proj);
+    } else {
+      bbox = BBox::From(proj, proj);
+      hasBBox = true;
+    }
+  }
+
+  void ScreenBBoxCanvas::DrawLine(const Vector &a, const Vector &b, hStroke hcs) {
+    Include(a);
+    Include(b);
+  }
+
+  void ScreenBBoxCanvas::DrawEdges(const SEdgeList &el, hStroke hcs) {
+    for (const SEdge &e : el.l) {
+      Include(e.a);
+      Include(e.b);
+    }
+  }
+
+  void ScreenBBoxCanvas::DrawOutlines(const SOutlineList &ol, hStroke hcs,
+                                      DrawOutlinesAs drawAs) {
+    for (const SOutline &o : ol.l) {
+      Include(o.a);
+      Include(o.b);
+    }
+  }
+
+  void ScreenBBoxCanvas::DrawVectorText(const std::string &text, double height, const Vector &o,
+                                        const Vector &u, const Vector &v, hStroke hcs) {
+    double w = VectorFont::Builtin()->GetWidth(height, text),
+           h = VectorFont::Builtin()->GetHeight(height);
+    Include(o);
+    Include(o.Plus(v.ScaledBy(h)));
+    Include(o.Plus(u.ScaledBy(w)).Plus(v.ScaledBy(h)));
+    Include(o.Plus(u.ScaledBy(w)));
+  }
+
+  void ScreenBBoxCanvas::DrawQuad(const Vector &a, const Vector &b, const Vector &c,
+                                  const Vector &d, hFill hcf) {
+    Include(a);
+    Include(b);
+    Include(c);
+    Include(d);
+  }
+
+  void ScreenBBoxCanvas::DrawPoint(const Vector &o, Canvas::hStroke hcs) {
+    Include(o);
+  }
+
+  void ScreenBBoxCanvas::DrawPolygon(const SPolygon &p, hFill hcf) {
+    for (const SContour &sc : p.l) {
+      for (const SPoint &sp : sc.l) {
+        Include(sp.p);
+      }
+    }
+  }
+
+  void ScreenBBoxCanvas::DrawMesh(const SMesh &m, hFill hcfFront, hFill hcfBack) {
+    for (const STriangle &tr : m.l) {
+      Include(tr.a);
+      Include(tr.b);
+      Include(tr.c);
+    }
+  }
+
+  void ScreenBBoxCanvas::DrawFaces(const SMesh &m, const std::vector<uint32_t> &faces,
+                                   hFill hcf) {
+    for (const STriangle &tr : m.l) {
+      if (std::find(faces.begin(), faces.end(), tr.meta.face) == faces.end())
+        continue;
+      Include(tr.a);
+      Include(tr.b);
+      Include(tr.c);
+    }
+  }
+
+  void ScreenBBoxCanvas::DrawPixmap(std::shared_ptr<const Pixmap> pm, const Vector &o,
+                                    const Vector &u, const Vector &v, const Point2d &ta,
+                                    const Point2d &tb, Canvas::hFill hcf) {
+    DrawQuad(o, o.Plus(u), o.Plus(u).Plus(v), o.Plus(v), hcf);
+  }
+
+  BBox ScreenBBoxCanvas::Collect(const std::function<void()> &drawFn, bool *hasBBox) {
+    bbox = {};
+    this->hasBBox = false;
+
+    drawFn();
+    *hasBBox = this->hasBBox;
+    return bbox;
+  }
 } // namespace SolveSpace
@@ -272,6 +272,42 @@ public:
     bool Pick(const std::function<void()> &drawFn);
 };
 
+// A canvas that finds the screen bounding box of drawn geometry, leaving out
+// the width of its strokes.
+class ScreenBBoxCanvas : public Canvas {
+public:
+    Camera      camera  = {};
+    // State.
+    BBox        bbox    = {};
+    bool        hasBBox = false;
+
+    const Camera &GetCamera() const override { return camera; }
+
+    void DrawLine(const Vector &a, const Vector &b, hStroke hcs) override;
+    void DrawEdges(const SEdgeList &el, hStroke hcs) override;
+    bool DrawBeziers(const SBezierList &bl, hStroke hcs) override { return false; }
+    void DrawOutlines(const SOutlineList &ol, hStroke hcs, DrawOutlinesAs drawAs) override;
+    void DrawVectorText(const std::string &text, double height,
+                        const Vector &o, const Vector &u, const Vector &v,
+                        hStroke hcs) override;
+
+    void DrawQuad(const Vector &a, const Vector &b, const Vector &c, const Vector &d,
+                  hFill hcf) override;
+    void DrawPoint(const Vector &o, hStroke hcs) override;
+    void DrawPolygon(const SPolygon &p, hFill hcf) override;
+    void DrawMesh(const SMesh &m, hFill hcfFront, hFill hcfBack) override;
+    void DrawFaces(const SMesh &m, const std::vector<uint32_t> &faces, hFill hcf) override;
+
+    void DrawPixmap(std::shared_ptr<const Pixmap> pm,
+                    const Vector &o, const Vector &u, const Vector &v,
+                    const Point2d &ta, const Point2d &tb, hFill hcf) override;
+    void InvalidatePixmap(std::shared_ptr<const Pixmap> pm) override {}
+
+    void Include(const Vector &p);
+
+    BBox Collect(const std::function<void()> &drawFn, bool *hasBBox);
+};
+
 // A canvas that renders onto a 2d surface, performing z-index sorting, occlusion testing, etc,
 // on the CPU.
 class SurfaceRenderer : public ViewportCanvas {
@@ -286,6 +322,18 @@ public:
     SMesh       mesh = {};
     // State.
     BBox        bbox = {};
+    // Hidden line removal results, kept from frame to frame for as long as
+    // the mesh doesn't change. The mesh is already projected, so a change of
+    // camera changes it too.
+    class OccludedEdge {
+    public:
+        Vector              a, b;
+        // The pieces of the edge from a to b, tagged if hidden.
+        std::vector<SEdge>  pieces;
+    };
+    static const size_t MAX_OCCLUDED_EDGES = 1 << 20;
+    uint64_t    occlusionMeshHash = 0;
+    std::unordered_map<uint64_t, OccludedEdge> occludedEdges;
 
     void Clear() override;
 
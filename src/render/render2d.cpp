@@ -5,6 +5,8 @@
 //-----------------------------------------------------------------------------
 #include "solvespace.h"
 
+#include <deque>
+
 namespace SolveSpace {
 
   // FIXME: The export coordinate system has a different handedness than display
@@ -242,6 +244,17 @@ namespace SolveSpace {
     beziers.clear();
   }
 
+  static uint64_t OccludedEdgeKey(const SEdge &e) {
+    uint64_t hash = 14695981039346656037ull;
+    for (double d : {e.a.x, e.a.y, e.a.z, e.b.x, e.b.y, e.b.z}) {
+      uint64_t bits;
+      memcpy(&bits, &d, sizeof(bits));
+      hash ^= bits;
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
   void SurfaceRenderer::CullOccludedStrokes() {
     // Perform occlusion testing, if necessary.
     if (mesh.l.IsEmpty())
@@ -250,11 +263,19 @@ namespace SolveSpace {
     // We can't perform hidden line removal on exact curves.
     ConvertBeziersToEdges();
 
+    // Results from earlier frames still hold if the mesh is the same, which
+    // is the case whenever only the overlays (hover, selection) changed.
+    uint64_t meshHash = mesh.ContentHash();
+    if (meshHash != occlusionMeshHash || occludedEdges.size() > MAX_OCCLUDED_EDGES) {
+      occludedEdges.clear();
+      occlusionMeshHash = meshHash;
+    }
+
     // Remove hidden lines (on NORMAL layers), or remove visible lines (on OCCLUDED layers).
-    SKdNode *root = SKdNode::From(&mesh);
-    root->ClearTags();
+    // The kd-tree is built only once some edge misses the cache; it's in
+    // temporary memory, so it can't be kept for the next frame.
+    SKdNode *root = NULL;
 
-    int cnt = 1234;
     for (auto &eit : edges) {
       hStroke hcs = eit.first;
       SEdgeList &el = eit.second;
@@ -263,26 +284,60 @@ namespace SolveSpace {
       if (stroke->layer != Layer::NORMAL && stroke->layer != Layer::OCCLUDED)
         continue;
 
-      SEdgeList nel = {};
-      for (const SEdge &e : el.l) {
+      // Find the edges that we haven't tested yet, and test them in parallel.
+      // An edge whose key collides with a different one goes uncached.
+      std::vector<OccludedEdge *> found(el.l.n);
+      std::deque<OccludedEdge> uncached;
+      std::vector<int> missed;
+      for (int i = 0; i < el.l.n; i++) {
+        const SEdge &e = el.l[i];
+        auto it = occludedEdges.emplace(OccludedEdgeKey(e), OccludedEdge());
+        OccludedEdge *oe = &it.first->second;
+        bool miss = it.second;
+        if (!miss && (!oe->a.EqualsExactly(e.a) || !oe->b.EqualsExactly(e.b))) {
+          uncached.emplace_back();
+          oe = &uncached.back();
+          miss = true;
+        }
+        if (miss) {
+          oe->a = e.a;
+          oe->b = e.b;
+          missed.push_back(i);
+        }
+        found[i] = oe;
+      }
+      if (!missed.empty() && root == NULL) {
+        root = SKdNode::From(&mesh);
+      }
+#pragma omp parallel for schedule(dynamic)
+      for (int j = 0; j < (int)missed.size(); j++) {
+        const SEdge &e = el.l[missed[j]];
         SEdgeList oel = {};
         oel.AddEdge(e.a, e.b);
-        root->OcclusionTestLine(e, &oel, cnt);
+        root->OcclusionTestLine(e, &oel);
+        found[missed[j]]->pieces.assign(oel.l.begin(), oel.l.end());
+        oel.Clear();
+      }
 
-        if (stroke->layer == Layer::OCCLUDED) {
-          for (SEdge &oe : oel.l) {
-            oe.tag = !oe.tag;
+      SEdgeList nel = {};
+      for (int i = 0; i < el.l.n; i++) {
+        const SEdge &e = el.l[i];
+        SEdgeList oel = {};
+        for (SEdge piece : found[i]->pieces) {
+          if (stroke->layer == Layer::OCCLUDED) {
+            piece.tag = !piece.tag;
+          }
+          if (!piece.tag) {
+            oel.l.Add(&piece);
           }
         }
-        oel.l.RemoveTagged();
 
         oel.MergeCollinearSegments(e.a, e.b);
-        for (const SEdge &oe : oel.l) {
-          nel.AddEdge(oe.a, oe.b);
+        for (const SEdge &me : oel.l) {
+          nel.AddEdge(me.a, me.b);
         }
 
         oel.Clear();
-        cnt++;
       }
 
       el.l.Clear();
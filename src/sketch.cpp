@@ -77,4 +77,98 @@ Group *Sketch::GetRunningMeshGroupFor(hGroup h) {
     g = g->PreviousGroup();
   }
   return NULL;
-}
\ No newline at end of file
+}
+
+hGroup Sketch::GroupOfEntity(hEntity he) {
+  if (he.isFromRequest()) {
+    Request *r = request.FindByIdNoOops(he.request());
+    return r ? r->group : hGroup{0};
+  }
+  return he.group();
+}
+
+//-----------------------------------------------------------------------------
+// Find what each group depends on: its operands, the entities that define
+// its workplane or transformation, and the entities that its requests and
+// constraints refer to. A change to a group can only affect the groups that
+// depend on it, directly or not. The dependencies always come earlier in the
+// group order, so walking that order reaches everything downstream.
+//-----------------------------------------------------------------------------
+void Sketch::FindGroupDependencies(std::map<uint32_t, std::vector<hGroup>> *deps) {
+  deps->clear();
+  auto add = [&](hGroup hg, hGroup dep) {
+    if (dep.v == 0 || dep == hg)
+      return;
+    std::vector<hGroup> &d = (*deps)[hg.v];
+    if (std::find(d.begin(), d.end(), dep) == d.end())
+      d.push_back(dep);
+  };
+  auto addEntity = [&](hGroup hg, hEntity he) {
+    if (he.v == 0)
+      return;
+    add(hg, GroupOfEntity(he));
+  };
+
+  for (const Group &g : group) {
+    add(g.h, g.opA);
+    add(g.h, g.opB);
+    addEntity(g.h, g.predef.origin);
+    addEntity(g.h, g.predef.entityB);
+    addEntity(g.h, g.predef.entityC);
+  }
+  for (const Request &r : request) {
+    addEntity(r.group, r.workplane);
+  }
+  for (const Constraint &c : constraint) {
+    addEntity(c.group, c.workplane);
+    addEntity(c.group, c.ptA);
+    addEntity(c.group, c.ptB);
+    addEntity(c.group, c.entityA);
+    addEntity(c.group, c.entityB);
+    addEntity(c.group, c.entityC);
+    addEntity(c.group, c.entityD);
+  }
+}
+
+const Sketch::GroupItems &Sketch::ItemsInGroup(hGroup hg) {
+  if (!groupItemsBuilt || groupItemsRequestVersion != request.version ||
+      groupItemsConstraintVersion != constraint.version) {
+    groupItems.clear();
+    for (const Request &r : request) {
+      groupItems[r.group.v].request.push_back(r.h);
+    }
+    for (const Constraint &c : constraint) {
+      groupItems[c.group.v].constraint.push_back(c.h);
+    }
+    groupItemsRequestVersion = request.version;
+    groupItemsConstraintVersion = constraint.version;
+    groupItemsBuilt = true;
+  }
+
+  static const GroupItems empty = {};
+  auto it = groupItems.find(hg.v);
+  return (it == groupItems.end()) ? empty : it->second;
+}
+
+//-----------------------------------------------------------------------------
+// The entities of a group come from its requests and from the group itself.
+// The handles of those generated by one request, or by the group, are all
+// in a range of their own, so the entities can be found by looking up those
+// ranges in the sorted list, without looking at any other entity.
+//-----------------------------------------------------------------------------
+void Sketch::EntitiesInGroup(hGroup hg, std::vector<Entity *> *entities) {
+  entities->clear();
+  auto addRange = [&](hEntity first) {
+    for (int i = entity.LowerBound(first); i < entity.n; i++) {
+      Entity *e = &entity[i];
+      if ((e->h.v & 0xffff0000) != first.v)
+        break;
+      if (e->group == hg)
+        entities->push_back(e);
+    }
+  };
+  for (hRequest hr : ItemsInGroup(hg).request) {
+    addRange(hr.entity(0));
+  }
+  addRange(hg.entity(0));
+}
@@ -24,4 +24,24 @@ class Sketch {
 
   BBox   CalculateEntityBBox (bool includingInvisible);
   Group *GetRunningMeshGroupFor (hGroup h);
+
+  // The groups that each group depends on directly, indexed by group
+  hGroup GroupOfEntity (hEntity he);
+  void   FindGroupDependencies (std::map<uint32_t, std::vector<hGroup>> *deps);
+
+  // The requests and constraints in each group, in order of their handles.
+  // This is built on demand, and again whenever either list has gained or
+  // lost elements since.
+  struct GroupItems {
+    std::vector<hRequest>    request;
+    std::vector<hConstraint> constraint;
+  };
+  const GroupItems &ItemsInGroup (hGroup hg);
+  // The entities in a group, in order of their handles
+  void EntitiesInGroup (hGroup hg, std::vector<Entity *> *entities);
+
+  private:
+  std::map<uint32_t, GroupItems> groupItems;
+  uint64_t                       groupItemsRequestVersion = 0, groupItemsConstraintVersion = 0;
+  bool                           groupItemsBuilt = false;
 };
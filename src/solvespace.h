@@ -15,6 +15,8 @@
 #undef Success
 #include <Eigen/SparseCore>
 
+#include <mutex>
+
 // We declare these in advance instead of simply using FT_Library
 // (defined as typedef FT_LibraryRec_* FT_Library) because including
 // freetype.h invokes indescribable horrors and we would like to avoid
@@ -73,6 +75,17 @@ namespace SolveSpace {
     return v;
   }
 
+  // Mix a word into a running hash, for keying caches. Every step runs the
+  // splitmix64 finalizer, so that any bit of any word can change any bit of
+  // the hash; xor-and-multiply of whole words would let the top bits cancel.
+  static constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+  inline uint64_t HashMix (uint64_t hash, uint64_t v) {
+    uint64_t z = (hash ^ v) + 0x9e3779b97f4a7c15ull;
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+
 #define CO(v) (v).x, (v).y, (v).z
 
   static constexpr double ANGLE_COS_EPS = 1e-6;
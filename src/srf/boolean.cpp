@@ -7,6 +7,9 @@
 #include "solvespace.h"
 #include "ssg.h"
 
+#include <deque>
+#include <unordered_map>
+
 static int I;
 
 void SShell::MakeFromUnionOf(SShell *a, SShell *b) {
@@ -204,18 +207,21 @@ SCurve SCurve::MakeCopySplitAgainst(SShell *agnstA, SShell *agnstB, SSurface *sr
 }
 
 void SShell::CopyCurvesSplitAgainst(bool opA, SShell *agnst, SShell *into) {
-#pragma omp parallel for
+  // Split all the curves in parallel, but assign the new IDs in order, so
+  // that they don't depend on which thread finished first.
+  std::vector<SCurve> scn(curve.n);
+#pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < curve.n; i++) {
+    SSurface::ForgetClosestPointGuesses();
     SCurve *sc = &curve[i];
-    SCurve scn = sc->MakeCopySplitAgainst(agnst, NULL, surface.FindById(sc->surfA),
+    scn[i]     = sc->MakeCopySplitAgainst(agnst, NULL, surface.FindById(sc->surfA),
                                           surface.FindById(sc->surfB));
-    scn.source = opA ? SCurve::Source::A : SCurve::Source::B;
-#pragma omp critical
-    {
-      hSCurve hsc = into->curve.AddAndAssignId(&scn);
-      // And note the new ID so that we can rewrite the trims appropriately
-      sc->newH = hsc;
-    }
+    scn[i].source = opA ? SCurve::Source::A : SCurve::Source::B;
+  }
+
+  for (int i = 0; i < curve.n; i++) {
+    // And note the new ID so that we can rewrite the trims appropriately
+    curve[i].newH = into->curve.AddAndAssignId(&scn[i]);
   }
 }
 
@@ -582,7 +588,7 @@ SSurface SSurface::MakeCopyTrimAgainst(SShell *parent, SShell *sha, SShell *shb,
       sp->tag = 0;
     }
   }
-  choosing.l.RemoveTagged();
+  choosing.RemoveTagged();
 
   // The list of edges to trim our new surface, a combination of edges from
   // our original and intersecting edge lists.
@@ -676,8 +682,9 @@ SSurface SSurface::MakeCopyTrimAgainst(SShell *parent, SShell *sha, SShell *shb,
 void SShell::CopySurfacesTrimAgainst(SShell *sha, SShell *shb, SShell *into,
                                      SSurface::CombineAs type) {
   std::vector<SSurface> ssn(surface.n);
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < surface.n; i++) {
+    SSurface::ForgetClosestPointGuesses();
     SSurface *ss = &surface[i];
     ssn[i] = ss->MakeCopyTrimAgainst(this, sha, shb, into, type, i);
   }
@@ -689,16 +696,71 @@ void SShell::CopySurfacesTrimAgainst(SShell *sha, SShell *shb, SShell *into,
 }
 
 void SShell::MakeIntersectionCurvesAgainst(SShell *agnst, SShell *into) {
-#pragma omp parallel for
-  for (int i = 0; i < surface.n; i++) {
-    SSurface *sa = &surface[i];
+  ssassert(!surfaceBvh.IsEmpty() || surface.IsEmpty(), "Expected surface BVH to be built");
+  ssassert(!agnst->surfaceBvh.IsEmpty() || agnst->surface.IsEmpty(),
+           "Expected surface BVH to be built");
+
+  // Only surfaces whose bounding boxes overlap can intersect, so get those
+  // pairs from the two hierarchies instead of trying every combination.
+  std::vector<std::pair<int, int>> pairs;
+  surfaceBvh.OverlappingPairsWith(&agnst->surfaceBvh, &pairs);
+
+  // Each pair writes its curves to its own list, and into doesn't change
+  // until they're all done.
+  std::vector<List<SCurve>> curves(pairs.size());
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int)pairs.size(); i++) {
+    SSurface::ForgetClosestPointGuesses();
+    SSurface *sa = &surface[pairs[i].first], *sb = &agnst->surface[pairs[i].second];
+    sa->IntersectAgainst(sb, this, agnst, into, &curves[i]);
+  }
 
-    for (SSurface &sb : agnst->surface) {
-      // Intersect every surface from our shell against every surface
-      // from agnst; this will add zero or more curves to the curve
-      // list for into.
-      sa->IntersectAgainst(&sb, this, agnst, into);
+  // Then add them in the order of the pairs.
+  int first = into->curve.n;
+  for (int i = 0; i < (int)pairs.size(); i++) {
+    SSurface *sa = &surface[pairs[i].first], *sb = &agnst->surface[pairs[i].second];
+    for (SCurve &sc : curves[i]) {
+      if (sc.isExact) {
+        // If an earlier pair already generated this curve, then follow its
+        // pwl exactly, and decide from that whether the curve is fake, as
+        // we would have if the pairs ran in sequence.
+        SBezier rev = sc.exact;
+        rev.Reverse();
+        bool earlier = false;
+        for (int j = first; j < into->curve.n; j++) {
+          SCurve *se = &into->curve[j];
+          if (!se->isExact)
+            continue;
+          bool backwards = false;
+          if (!sc.exact.Equals(&(se->exact))) {
+            if (!rev.Equals(&(se->exact)))
+              continue;
+            backwards = true;
+          }
+          sc.pts.Clear();
+          for (SCurvePt &pt : se->pts) {
+            sc.pts.Add(&pt);
+          }
+          if (backwards)
+            sc.pts.Reverse();
+          earlier = true;
+          break;
+        }
+        if (earlier) {
+          SSurface::ForgetClosestPointGuesses();
+          if (!sa->IntersectionCurveWithin(&(sc.pts), sb)) {
+            sc.Clear();
+            continue;
+          }
+        } else if (sc.pts.IsEmpty()) {
+          // Its own pwl lies outside one of the surfaces.
+          sc.Clear();
+          continue;
+        }
+      }
+      into->curve.AddAndAssignId(&sc);
     }
+    curves[i].Clear();
   }
 }
 
@@ -771,12 +833,331 @@ void SShell::MakeFromAssemblyOf(SShell *a, SShell *b) {
   RewriteSurfaceHandlesForCurves(a, b);
 }
 
+//-----------------------------------------------------------------------------
+// A bounding volume hierarchy over the surfaces of a shell. We split at the
+// median of the bounding box centers, along the axis where those centers are
+// most spread out.
+//-----------------------------------------------------------------------------
+void SSurfaceBvh::Build(SShell *shell) {
+  Clear();
+
+  item.reserve(shell->surface.n);
+  for (int i = 0; i < shell->surface.n; i++) {
+    Item it;
+    shell->surface[i].GetAxisAlignedBounding(&it.max, &it.min);
+    it.surface = i;
+    item.push_back(it);
+  }
+  if (item.empty())
+    return;
+
+  node.reserve(2 * item.size());
+  BuildNode(0, (int)item.size());
+
+  // Each surface's patches get built by the first ray cast against it.
+  patches.resize(item.size());
+}
+
+int SSurfaceBvh::BuildNode(int first, int count) {
+  int n = (int)node.size();
+  node.emplace_back();
+
+  Vector max = Vector::From(VERY_NEGATIVE, VERY_NEGATIVE, VERY_NEGATIVE),
+         min = Vector::From(VERY_POSITIVE, VERY_POSITIVE, VERY_POSITIVE);
+  Vector cmax = max, cmin = min;
+  for (int i = first; i < first + count; i++) {
+    const Item &it = item[i];
+    (it.max).MakeMaxMin(max, min);
+    (it.min).MakeMaxMin(max, min);
+    (it.max.Plus(it.min)).ScaledBy(0.5).MakeMaxMin(cmax, cmin);
+  }
+  node[n].max   = max;
+  node[n].min   = min;
+  node[n].first = first;
+  node[n].count = count;
+
+  if (count <= LEAF_SIZE) {
+    node[n].left = node[n].right = -1;
+    return n;
+  }
+
+  Vector extent = cmax.Minus(cmin);
+  int axis      = 0;
+  for (int i = 1; i < 3; i++) {
+    if (extent.Element(i) > extent.Element(axis))
+      axis = i;
+  }
+
+  int half = count / 2;
+  std::nth_element(item.begin() + first, item.begin() + first + half,
+                   item.begin() + first + count, [&](const Item &a, const Item &b) {
+                     return a.max.Element(axis) + a.min.Element(axis) <
+                            b.max.Element(axis) + b.min.Element(axis);
+                   });
+
+  // Build the children first, since that may reallocate node.
+  int left      = BuildNode(first, half);
+  int right     = BuildNode(first + half, count - half);
+  node[n].left  = left;
+  node[n].right = right;
+  return n;
+}
+
+bool SSurfaceBvh::IsEmpty() const {
+  return node.empty();
+}
+
+void SSurfaceBvh::Clear() {
+  node.clear();
+  node.shrink_to_fit();
+  item.clear();
+  item.shrink_to_fit();
+  patches.clear();
+  patches.shrink_to_fit();
+}
+
+//-----------------------------------------------------------------------------
+// Find every pair of surfaces (one from us, one from b) whose bounding boxes
+// overlap, as indices into the respective SShell::surface lists. The pairs
+// are returned sorted, so that they're visited in the same order as a loop
+// over all the combinations would.
+//-----------------------------------------------------------------------------
+void SSurfaceBvh::OverlappingPairsWith(const SSurfaceBvh *b,
+                                       std::vector<std::pair<int, int>> *pairs) const {
+  if (IsEmpty() || b->IsEmpty())
+    return;
+
+  PairsWorker(0, b, 0, pairs);
+  std::sort(pairs->begin(), pairs->end());
+}
+
+void SSurfaceBvh::PairsWorker(int na, const SSurfaceBvh *b, int nb,
+                              std::vector<std::pair<int, int>> *pairs) const {
+  const Node &x = node[na], &y = b->node[nb];
+  if (VectorBoundingBoxesDisjoint(x.max, x.min, y.max, y.min))
+    return;
+
+  if (x.left < 0 && y.left < 0) {
+    for (int i = x.first; i < x.first + x.count; i++) {
+      const Item &ia = item[i];
+      for (int j = y.first; j < y.first + y.count; j++) {
+        const Item &ib = b->item[j];
+        if (!VectorBoundingBoxesDisjoint(ia.max, ia.min, ib.max, ib.min)) {
+          pairs->emplace_back(ia.surface, ib.surface);
+        }
+      }
+    }
+    return;
+  }
+
+  // Descend into the larger of the two nodes, unless it's a leaf.
+  if (y.left < 0 || (x.left >= 0 && x.count >= y.count)) {
+    PairsWorker(x.left, b, nb, pairs);
+    PairsWorker(x.right, b, nb, pairs);
+  } else {
+    PairsWorker(na, b, y.left, pairs);
+    PairsWorker(na, b, y.right, pairs);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Find the surfaces whose bounding boxes might be crossed by the line through
+// a and b (or just the segment, if asSegment), in ascending order of index.
+//-----------------------------------------------------------------------------
+void SSurfaceBvh::SurfacesAlongLine(Vector a, Vector b, bool asSegment,
+                                    std::vector<int> *l) const {
+  if (IsEmpty())
+    return;
+
+  std::vector<int> stack;
+  stack.push_back(0);
+  while (!stack.empty()) {
+    const Node &n = node[stack.back()];
+    stack.pop_back();
+    if (SSurface::LineEntirelyOutsideBox(n.max, n.min, a, b, asSegment))
+      continue;
+
+    if (n.left >= 0) {
+      stack.push_back(n.right);
+      stack.push_back(n.left);
+      continue;
+    }
+    for (int i = n.first; i < n.first + n.count; i++) {
+      const Item &it = item[i];
+      if (!SSurface::LineEntirelyOutsideBox(it.max, it.min, a, b, asSegment)) {
+        l->push_back(it.surface);
+      }
+    }
+  }
+  std::sort(l->begin(), l->end());
+}
+
+//-----------------------------------------------------------------------------
+// The classifying BSPs of the Boolean operands, kept from one Boolean to the
+// next. A BSP depends only on the surface and on the trim edges that it's
+// built from, so we key them by a hash of those, and keep those to compare
+// on a hit; then the running shell of an unchanged group gets its BSPs back,
+// instead of building them again for every later group. Their nodes come
+// from the entry's own storage and not the temporary heap, so that they
+// survive FreeAllTemporary.
+//-----------------------------------------------------------------------------
+class SBspUvCache {
+  public:
+  static const size_t MAX_ENTRIES = 16384;
+
+  struct Entry {
+    std::deque<SBspUv> nodes;
+    SBspUv            *root;
+    uint64_t           lastUsed;
+
+    // What the BSP was built from.
+    int                 degm, degn;
+    std::vector<double> ctrl;
+    std::vector<double> uv;
+
+    static void Describe(SSurface *srf, SEdgeList *el, std::vector<double> *ctrl,
+                         std::vector<double> *uv) {
+      for (int i = 0; i <= srf->degm; i++) {
+        for (int j = 0; j <= srf->degn; j++) {
+          ctrl->push_back(srf->ctrl[i][j].x);
+          ctrl->push_back(srf->ctrl[i][j].y);
+          ctrl->push_back(srf->ctrl[i][j].z);
+          ctrl->push_back(srf->weight[i][j]);
+        }
+      }
+      for (const SEdge &se : el->l) {
+        uv->push_back(se.a.x);
+        uv->push_back(se.a.y);
+        uv->push_back(se.b.x);
+        uv->push_back(se.b.y);
+      }
+    }
+
+    void BuiltFrom(SSurface *srf, SEdgeList *el) {
+      degm = srf->degm;
+      degn = srf->degn;
+      Describe(srf, el, &ctrl, &uv);
+    }
+
+    bool IsFrom(SSurface *srf, SEdgeList *el) const {
+      if (degm != srf->degm || degn != srf->degn)
+        return false;
+      std::vector<double> c, u;
+      Describe(srf, el, &c, &u);
+      return c == ctrl && u == uv;
+    }
+  };
+  std::unordered_map<uint64_t, std::unique_ptr<Entry>> entries;
+  // Built for a key that another entry already has; kept only until the
+  // end of the Boolean that uses them.
+  std::vector<std::unique_ptr<Entry>> collided;
+  // Incremented for each Boolean; entries used by the current one must
+  // not be evicted, since its surfaces point into them.
+  uint64_t generation = 0;
+
+  static SBspUvCache *Get() {
+    static SBspUvCache cache;
+    return &cache;
+  }
+
+  static uint64_t KeyFor(SSurface *srf, SEdgeList *el) {
+    uint64_t key = 14695981039346656037ull;
+    auto add     = [&](double d) {
+      uint64_t bits;
+      memcpy(&bits, &d, sizeof(bits));
+      key ^= bits;
+      key *= 1099511628211ull;
+    };
+    add(srf->degm);
+    add(srf->degn);
+    for (int i = 0; i <= srf->degm; i++) {
+      for (int j = 0; j <= srf->degn; j++) {
+        add(srf->ctrl[i][j].x);
+        add(srf->ctrl[i][j].y);
+        add(srf->ctrl[i][j].z);
+        add(srf->weight[i][j]);
+      }
+    }
+    for (const SEdge &se : el->l) {
+      add(se.a.x);
+      add(se.a.y);
+      add(se.b.x);
+      add(se.b.y);
+    }
+    return key;
+  }
+
+  bool Find(uint64_t key, SSurface *srf, SEdgeList *el, SBspUv **root) {
+    auto it = entries.find(key);
+    if (it == entries.end())
+      return false;
+    if (!it->second->IsFrom(srf, el))
+      return false;
+    it->second->lastUsed = generation;
+    *root                = it->second->root;
+    return true;
+  }
+
+  // Returns the root of the BSP that's now cached for this key, which might
+  // have been added by another thread since we looked. If the key is taken
+  // by something else, then the entry isn't cached, and its BSP is only
+  // good until the next Clear() or Trim().
+  SBspUv *Add(uint64_t key, std::unique_ptr<Entry> entry, SSurface *srf, SEdgeList *el) {
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+      it = entries.emplace(key, std::move(entry)).first;
+    } else if (!it->second->IsFrom(srf, el)) {
+      entry->lastUsed = generation;
+      collided.push_back(std::move(entry));
+      return collided.back()->root;
+    }
+    it->second->lastUsed = generation;
+    return it->second->root;
+  }
+
+  void Clear() {
+    entries.clear();
+    collided.clear();
+  }
+
+  void Trim() {
+    collided.clear();
+    if (entries.size() <= MAX_ENTRIES)
+      return;
+    std::vector<std::pair<uint64_t, uint64_t>> byAge;
+    for (auto &it : entries) {
+      if (it.second->lastUsed < generation) {
+        byAge.emplace_back(it.second->lastUsed, it.first);
+      }
+    }
+    std::sort(byAge.begin(), byAge.end());
+    for (auto &age : byAge) {
+      if (entries.size() <= MAX_ENTRIES)
+        break;
+      entries.erase(age.second);
+    }
+  }
+};
+
+void SShell::ClearClassifyingBspCache() {
+  SBspUvCache::Get()->Clear();
+}
+
+// Where SBspUv::Alloc puts new nodes, if not on the temporary heap.
+static thread_local std::deque<SBspUv> *BspNodesInto = NULL;
+
 void SShell::MakeFromBoolean(SShell *a, SShell *b, SSurface::CombineAs type) {
   booleanFailed = false;
 
+  SBspUvCache::Get()->generation++;
   a->MakeClassifyingBsps(NULL);
   b->MakeClassifyingBsps(NULL);
 
+  // The surfaces of a and b don't change until we're done, so index them
+  // once for all the intersection and classification queries below.
+  a->surfaceBvh.Build(a);
+  b->surfaceBvh.Build(b);
+
   // Copy over all the original curves, splitting them so that a
   // piecewise linear segment never crosses a surface from the other
   // shell.
@@ -787,10 +1168,13 @@ void SShell::MakeFromBoolean(SShell *a, SShell *b, SSurface::CombineAs type) {
   // the surfaces in B (which is all of the intersection curves).
   a->MakeIntersectionCurvesAgainst(b, this);
 
-  for (SCurve &sc : curve) {
-    SSurface *srfA = sc.GetSurfaceA(a, b), *srfB = sc.GetSurfaceB(a, b);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < curve.n; i++) {
+    SSurface::ForgetClosestPointGuesses();
+    SCurve *sc     = &curve[i];
+    SSurface *srfA = sc->GetSurfaceA(a, b), *srfB = sc->GetSurfaceB(a, b);
 
-    sc.RemoveShortSegments(srfA, srfB);
+    sc->RemoveShortSegments(srfA, srfB);
   }
 
   // And clean up the piecewise linear things we made as a calculation aid
@@ -818,6 +1202,12 @@ void SShell::MakeFromBoolean(SShell *a, SShell *b, SSurface::CombineAs type) {
   // And clean up the piecewise linear things we made as a calculation aid
   a->CleanupAfterBoolean();
   b->CleanupAfterBoolean();
+  a->surfaceBvh.Clear();
+  b->surfaceBvh.Clear();
+  SBspUvCache::Get()->Trim();
+  // So that whatever runs next on this thread doesn't depend on which of
+  // our work it happened to do.
+  SSurface::ForgetClosestPointGuesses();
 }
 
 //-----------------------------------------------------------------------------
@@ -826,6 +1216,7 @@ void SShell::MakeFromBoolean(SShell *a, SShell *b, SSurface::CombineAs type) {
 void SShell::MakeClassifyingBsps(SShell *useCurvesFrom) {
 #pragma omp parallel for
   for (int i = 0; i < surface.n; i++) {
+    SSurface::ForgetClosestPointGuesses();
     surface[i].MakeClassifyingBsp(this, useCurvesFrom);
   }
 }
@@ -834,7 +1225,26 @@ void SSurface::MakeClassifyingBsp(SShell *shell, SShell *useCurvesFrom) {
   SEdgeList el = {};
 
   MakeEdgesInto(shell, &el, MakeAs::UV, useCurvesFrom);
-  bsp = SBspUv::From(&el, this);
+  if (useCurvesFrom) {
+    // Trimmed by the curves split for this Boolean, so unlikely to be seen
+    // again; not worth keeping.
+    bsp = SBspUv::From(&el, this);
+  } else {
+    SBspUvCache *cache = SBspUvCache::Get();
+    uint64_t key       = SBspUvCache::KeyFor(this, &el);
+    bool found;
+#pragma omp critical(bspcache)
+    { found = cache->Find(key, this, &el, &bsp); }
+    if (!found) {
+      std::unique_ptr<SBspUvCache::Entry> entry(new SBspUvCache::Entry());
+      BspNodesInto = &entry->nodes;
+      entry->root  = SBspUv::From(&el, this);
+      BspNodesInto = NULL;
+      entry->BuiltFrom(this, &el);
+#pragma omp critical(bspcache)
+      { bsp = cache->Add(key, std::move(entry), this, &el); }
+    }
+  }
   el.Clear();
 
   edges = {};
@@ -842,6 +1252,10 @@ void SSurface::MakeClassifyingBsp(SShell *shell, SShell *useCurvesFrom) {
 }
 
 SBspUv *SBspUv::Alloc() {
+  if (BspNodesInto) {
+    BspNodesInto->emplace_back();
+    return &BspNodesInto->back();
+  }
   return (SBspUv *)AllocTemporary(sizeof(SBspUv));
 }
 
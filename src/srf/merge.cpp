@@ -7,12 +7,126 @@
 #include "../solvespace.h"
 #include "ssg.h"
 
+#include <unordered_map>
+
+//-----------------------------------------------------------------------------
+// Coincident planes have almost the same unit normal and distance from the
+// origin. CoincidentWith() accepts a surface whose corners all lie within
+// LENGTH_EPS of the other's plane, so each of its edges from ctrl[0][0] may
+// rise out of that plane by 2 * LENGTH_EPS; that bounds how far its normal
+// can turn, and from that how far its distance from the origin can move. So
+// we bucket the planar surfaces by their normal, quantized, and by color,
+// and sort each bucket by distance, and then only have to look at the
+// buckets and distances within those bounds. A surface so small that its
+// normal could turn by more than a bucket is compared against every other.
+//-----------------------------------------------------------------------------
+static const double MERGE_NORMAL_QUANTUM = 1e-3;
+
+class SMergePlane {
+public:
+  Vector n;
+  double d;
+  // How far the normal of a surface coincident with this one might be
+  // from ours, and so how far its distance might be from d.
+  double normalSlop;
+  double distSlop;
+
+  static SMergePlane From(SSurface *srf) {
+    SMergePlane mp = {};
+    Vector p  = srf->ctrl[0][0];
+    mp.n      = srf->NormalAt(0, 0).WithMagnitude(1);
+    mp.d      = mp.n.Dot(p);
+
+    // The normal is along a x b; anything in a or b out of the other plane
+    // contributes at most this much to it perpendicular to the other normal.
+    Vector a = srf->ctrl[1][0].Minus(p), b = srf->ctrl[0][1].Minus(p);
+    double area = a.Cross(b).Magnitude();
+    double out  = 2 * LENGTH_EPS * (a.Magnitude() + b.Magnitude()) + 4 * LENGTH_EPS * LENGTH_EPS;
+    // The chord between two unit normals is at most sqrt(2) times the sine
+    // of the angle between them, when they're on the same side.
+    mp.normalSlop = (area > out) ? 2 * out / area : VERY_POSITIVE;
+    mp.distSlop   = 2 * LENGTH_EPS + mp.normalSlop * p.Magnitude();
+    return mp;
+  }
+
+  bool Loose() const {
+    return normalSlop >= MERGE_NORMAL_QUANTUM;
+  }
+
+  void Cell(int64_t *cell) const {
+    cell[0] = (int64_t)floor(n.x / MERGE_NORMAL_QUANTUM);
+    cell[1] = (int64_t)floor(n.y / MERGE_NORMAL_QUANTUM);
+    cell[2] = (int64_t)floor(n.z / MERGE_NORMAL_QUANTUM);
+  }
+};
+
+static uint64_t PlaneBucketKey(const int64_t *cell, RgbaColor color) {
+  uint64_t key = 14695981039346656037ull;
+  for (int i = 0; i < 3; i++) {
+    key ^= (uint64_t)cell[i];
+    key *= 1099511628211ull;
+  }
+  key ^= color.ToPackedIntBGRA();
+  key *= 1099511628211ull;
+  return key;
+}
+
+// All the buckets that a surface coincident with this plane could be in.
+static void PlaneBucketKeys(const SMergePlane &mp, RgbaColor color, std::vector<uint64_t> *keys) {
+  int64_t lo[3], hi[3];
+  double  x[3] = {mp.n.x, mp.n.y, mp.n.z};
+  for (int i = 0; i < 3; i++) {
+    lo[i] = (int64_t)floor((x[i] - mp.normalSlop) / MERGE_NORMAL_QUANTUM);
+    hi[i] = (int64_t)floor((x[i] + mp.normalSlop) / MERGE_NORMAL_QUANTUM);
+  }
+  int64_t cell[3];
+  for (cell[0] = lo[0]; cell[0] <= hi[0]; cell[0]++) {
+    for (cell[1] = lo[1]; cell[1] <= hi[1]; cell[1]++) {
+      for (cell[2] = lo[2]; cell[2] <= hi[2]; cell[2]++) {
+        keys->push_back(PlaneBucketKey(cell, color));
+      }
+    }
+  }
+}
+
 void SShell::MergeCoincidentSurfaces() {
   surface.ClearTags();
 
-  int i, j;
+  int i;
   SSurface *si, *sj;
 
+  // Bucket the planar surfaces, so that we only have to try merging those
+  // that might be coincident. Candidates are tried in order of index, as
+  // they would be if we tried every one.
+  std::vector<SMergePlane> planes(surface.n);
+  std::vector<int> planar;
+  std::unordered_map<uint64_t, std::vector<std::pair<double, int>>> buckets;
+  for (i = 0; i < surface.n; i++) {
+    si = &(surface[i]);
+    if (si->degm != 1 || si->degn != 1)
+      continue;
+    planes[i] = SMergePlane::From(si);
+    planar.push_back(i);
+    int64_t cell[3];
+    planes[i].Cell(cell);
+    buckets[PlaneBucketKey(cell, si->color)].push_back({planes[i].d, i});
+  }
+  for (auto &it : buckets) {
+    std::sort(it.second.begin(), it.second.end());
+  }
+
+  // And note which curves trim each surface, so that we don't have to look
+  // at every curve when we rewrite their surface handles.
+  std::unordered_map<uint32_t, std::vector<int>> curvesOf;
+  for (int c = 0; c < curve.n; c++) {
+    curvesOf[curve[c].surfA.v].push_back(c);
+    if (curve[c].surfB.v != curve[c].surfA.v) {
+      curvesOf[curve[c].surfB.v].push_back(c);
+    }
+  }
+
+  std::vector<uint64_t> keys;
+  std::vector<int> candidates;
   for (i = 0; i < surface.n; i++) {
     si = &(surface[i]);
     if (si->tag)
@@ -26,6 +140,34 @@ void SShell::MergeCoincidentSurfaces() {
     if (si->degm != 1 || si->degn != 1)
       continue;
 
+    const SMergePlane &mp = planes[i];
+    candidates.clear();
+    if (mp.Loose()) {
+      for (int k : planar) {
+        if (k > i)
+          candidates.push_back(k);
+      }
+    } else {
+      keys.clear();
+      PlaneBucketKeys(mp, si->color, &keys);
+      for (uint64_t key : keys) {
+        auto it = buckets.find(key);
+        if (it == buckets.end())
+          continue;
+        std::vector<std::pair<double, int>> &bucket = it->second;
+        auto k = std::lower_bound(bucket.begin(), bucket.end(),
+                                  std::make_pair(mp.d - mp.distSlop, -1));
+        for (; k != bucket.end() && k->first <= mp.d + mp.distSlop; k++) {
+          if (k->second > i)
+            candidates.push_back(k->second);
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (candidates.empty())
+      continue;
+
     SEdgeList sel = {};
     si->MakeEdgesInto(this, &sel, SSurface::MakeAs::XYZ);
 
@@ -33,7 +175,7 @@ void SShell::MergeCoincidentSurfaces() {
     do {
       mergedThisTime = false;
 
-      for (j = i + 1; j < surface.n; j++) {
+      for (int j : candidates) {
         sj = &(surface[j]);
         if (sj->tag)
           continue;
@@ -64,12 +206,16 @@ void SShell::MergeCoincidentSurfaces() {
 
         // All the references to this surface get replaced with the
         // new srf
-        for (SCurve &sc : curve) {
-          if (sc.surfA == sj->h)
-            sc.surfA = si->h;
-          if (sc.surfB == sj->h)
-            sc.surfB = si->h;
+        std::vector<int> &from = curvesOf[sj->h.v], &to = curvesOf[si->h.v];
+        for (int c : from) {
+          SCurve *sc = &(curve[c]);
+          if (sc->surfA == sj->h)
+            sc->surfA = si->h;
+          if (sc->surfB == sj->h)
+            sc->surfB = si->h;
+          to.push_back(c);
         }
+        from.clear();
       }
 
       // If this iteration merged a contour onto ours, then we have to
@@ -357,6 +357,46 @@ Vector SSurface::NormalAt(double u, double v) const {
   return tu.Cross(tv);
 }
 
+//-----------------------------------------------------------------------------
+// The most recent answers from ClosestPointTo, for a few surfaces, which we
+// use as the first guess for the next point. They're kept per thread, and
+// forgotten at the start of each piece of work that a Boolean runs in
+// parallel, so that its result doesn't depend on which thread did what.
+//-----------------------------------------------------------------------------
+struct ClosestPointGuess {
+  const SSurface *srf;
+  Point2d         uv;
+};
+static const int CLOSEST_POINT_GUESSES = 4;
+static thread_local ClosestPointGuess ClosestPointGuesses[CLOSEST_POINT_GUESSES];
+static thread_local int ClosestPointGuessNext;
+
+static ClosestPointGuess *FindClosestPointGuess(const SSurface *srf) {
+  for (ClosestPointGuess &g : ClosestPointGuesses) {
+    if (g.srf == srf)
+      return &g;
+  }
+  return NULL;
+}
+
+static void RememberClosestPointGuess(const SSurface *srf, double u, double v) {
+  ClosestPointGuess *g = FindClosestPointGuess(srf);
+  if (!g) {
+    g                     = &ClosestPointGuesses[ClosestPointGuessNext];
+    ClosestPointGuessNext = (ClosestPointGuessNext + 1) % CLOSEST_POINT_GUESSES;
+    g->srf                = srf;
+  }
+  g->uv.x = u;
+  g->uv.y = v;
+}
+
+void SSurface::ForgetClosestPointGuesses() {
+  for (ClosestPointGuess &g : ClosestPointGuesses) {
+    g.srf = NULL;
+  }
+  ClosestPointGuessNext = 0;
+}
+
 void SSurface::ClosestPointTo(Vector p, Point2d *puv, bool mustConverge) {
   ClosestPointTo(p, &(puv->x), &(puv->y), mustConverge);
 }
@@ -408,11 +448,12 @@ void SSurface::ClosestPointTo(Vector p, double *u, double *v, bool mustConverge)
   // good if we're working our way along a curve or something else where
   // we project successive points that are close to each other; something
   // like a 20% speedup empirically.
-  if (mustConverge) {
-    double ut = cached.x, vt = cached.y;
+  ClosestPointGuess *guess = mustConverge ? FindClosestPointGuess(this) : NULL;
+  if (guess) {
+    double ut = guess->uv.x, vt = guess->uv.y;
     if (ClosestPointNewton(p, &ut, &vt, mustConverge)) {
-      cached.x = *u = ut;
-      cached.y = *v = vt;
+      guess->uv.x = *u = ut;
+      guess->uv.y = *v = vt;
       return;
     }
   }
@@ -436,8 +477,7 @@ void SSurface::ClosestPointTo(Vector p, double *u, double *v, bool mustConverge)
   }
 
   if (ClosestPointNewton(p, u, v, mustConverge)) {
-    cached.x = *u;
-    cached.y = *v;
+    RememberClosestPointGuess(this, *u, *v);
     return;
   }
 
@@ -230,16 +230,116 @@ void SSurface::AllPointsIntersectingUntrimmed(Vector a, Vector b, int *cnt, int
   surf1.AllPointsIntersectingUntrimmed(a, b, cnt, level, l, asSegment, sorig);
 }
 
+//-----------------------------------------------------------------------------
+// Subdivide the surface exactly as AllPointsIntersectingUntrimmed would, but
+// without a line to cull against, and keep the patches' bounding boxes. Then
+// each ray just walks the boxes.
+//-----------------------------------------------------------------------------
+void SPatchTree::BuildOnce(SSurface *srf) {
+  std::call_once(built, [&]() { Build(srf); });
+}
+
+void SPatchTree::Build(SSurface *srf) {
+  Clear();
+
+  // Planes and cylinders get intersected in closed form.
+  Vector center, axis, start, finish;
+  double radius;
+  if ((srf->degm == 1 && srf->degn == 1) ||
+      srf->IsCylinder(&axis, &center, &radius, &start, &finish)) {
+    return;
+  }
+
+  if (BuildNode(srf, 0) < 0) {
+    // Too many patches to be worth keeping, so just subdivide per ray.
+    Clear();
+  }
+}
+
+int SPatchTree::BuildNode(SSurface *srf, int level) {
+  if ((int)node.size() >= MAX_NODES)
+    return -1;
+
+  int n = (int)node.size();
+  node.emplace_back();
+  srf->GetAxisAlignedBounding(&node[n].max, &node[n].min);
+
+  if (srf->DepartureFromCoplanar() < 0.2 * SS.ChordTolMm()) {
+    int degm = srf->degm, degn = srf->degn;
+    node[n].center = (srf->ctrl[0][0])
+                         .Plus(srf->ctrl[0][degn])
+                         .Plus(srf->ctrl[degm][0])
+                         .Plus(srf->ctrl[degm][degn])
+                         .ScaledBy(0.25);
+    node[n].left = node[n].right = -1;
+    return n;
+  }
+
+  SSurface surf0, surf1;
+  srf->SplitInHalf((level & 1) == 0, &surf0, &surf1);
+
+  int left = BuildNode(&surf0, level + 1);
+  if (left < 0)
+    return -1;
+  int right = BuildNode(&surf1, level + 1);
+  if (right < 0)
+    return -1;
+  node[n].left  = left;
+  node[n].right = right;
+  return n;
+}
+
+bool SPatchTree::IsEmpty() const {
+  return node.empty();
+}
+
+void SPatchTree::Clear() {
+  node.clear();
+  node.shrink_to_fit();
+}
+
+void SPatchTree::AllPointsIntersecting(SSurface *sorig, Vector a, Vector b,
+                                       List<SSurface::Inter> *l, bool asSegment) const {
+  int cnt = 0;
+  std::vector<int> stack;
+  stack.push_back(0);
+  while (!stack.empty()) {
+    const Node &n = node[stack.back()];
+    stack.pop_back();
+    if (SSurface::LineEntirelyOutsideBox(n.max, n.min, a, b, asSegment))
+      continue;
+
+    if (cnt > 2000) {
+      dbp("!!! too many subdivisions (cached patches)!");
+      return;
+    }
+    cnt++;
+
+    if (n.left >= 0) {
+      stack.push_back(n.right);
+      stack.push_back(n.left);
+      continue;
+    }
+
+    SSurface::Inter inter;
+    sorig->ClosestPointTo(n.center, &(inter.p.x), &(inter.p.y), /*mustConverge=*/false);
+    if (sorig->PointIntersectingLine(a, b, &(inter.p.x), &(inter.p.y))) {
+      l->Add(&inter);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 // Find all points where a line through a and b intersects our surface, and
 // add them to the list. If seg is true then report only intersections that
 // lie within the finite line segment (not including the endpoints); otherwise
 // we work along the infinite line. And we report either just intersections
 // inside the trim curve, or any intersection with u, v in [0, 1]. And we
-// either disregard or report tangent points.
+// either disregard or report tangent points. If we've already been split
+// into patches, then those are used instead of subdividing again.
 //-----------------------------------------------------------------------------
 void SSurface::AllPointsIntersecting(Vector a, Vector b, List<SInter> *l, bool asSegment,
-                                     bool trimmed, bool inclTangent) {
+                                     bool trimmed, bool inclTangent, const SPatchTree *patches) {
   if (LineEntirelyOutsideBbox(a, b, asSegment))
     return;
 
@@ -320,6 +420,9 @@ void SSurface::AllPointsIntersecting(Vector a, Vector b, List<SInter> *l, bool a
       ClosestPointTo(p, &(inter.p.x), &(inter.p.y));
       inters.Add(&inter);
     }
+  } else if (patches && !patches->IsEmpty()) {
+    // General numerical solution, with the subdivision done already
+    patches->AllPointsIntersecting(this, a, b, &inters, asSegment);
   } else {
     // General numerical solution by subdivision, fallback
     int cnt = 0, level = 0;
@@ -370,6 +473,18 @@ void SSurface::AllPointsIntersecting(Vector a, Vector b, List<SInter> *l, bool a
 
 void SShell::AllPointsIntersecting(Vector a, Vector b, List<SInter> *il, bool asSegment,
                                    bool trimmed, bool inclTangent) {
+  if (!surfaceBvh.IsEmpty()) {
+    // During a Boolean, skip the surfaces whose bounding boxes we miss.
+    std::vector<int> near;
+    surfaceBvh.SurfacesAlongLine(a, b, asSegment, &near);
+    for (int i : near) {
+      SPatchTree *patches = &surfaceBvh.patches[i];
+      patches->BuildOnce(&surface[i]);
+      surface[i].AllPointsIntersecting(a, b, il, asSegment, trimmed, inclTangent, patches);
+    }
+    return;
+  }
+
   for (SSurface &ss : surface) {
     ss.AllPointsIntersecting(a, b, il, asSegment, trimmed, inclTangent);
   }
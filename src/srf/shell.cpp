@@ -570,12 +570,24 @@ void SShell::MakeSectionEdgesInto(Vector n, double d, SEdgeList *sel, SBezierLis
 }
 
 void SShell::TriangulateInto(SMesh *sm) {
-#pragma omp parallel for
+  // The surfaces are triangulated independently of each other, so split them
+  // up across threads, and then collect the triangles in surface order; that
+  // way the mesh comes out the same however the threads are scheduled. The
+  // trim curves get projected into uv starting from each thread's recent
+  // guesses, so those have to be forgotten for each surface too.
+  std::vector<SMesh> meshes(surface.n);
+#pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < surface.n; i++) {
-    SSurface *s = &surface[i];
-    SMesh m;
-    s->TriangulateInto(this, &m);
-#pragma omp critical
+    SSurface::ForgetClosestPointGuesses();
+    surface[i].TriangulateInto(this, &meshes[i]);
+  }
+
+  int n = 0;
+  for (SMesh &m : meshes) {
+    n += m.l.n;
+  }
+  sm->l.ReserveMore(n);
+  for (SMesh &m : meshes) {
     sm->MakeFromCopyOf(&m);
     m.Clear();
   }
@@ -585,6 +597,69 @@ bool SShell::IsEmpty() const {
   return surface.IsEmpty();
 }
 
+//-----------------------------------------------------------------------------
+// Append everything that a Boolean reads from the shell to words, so that
+// two shells with the same words give the same result as operands.
+//-----------------------------------------------------------------------------
+void SShell::ContentInto(std::vector<uint64_t> *words) {
+  auto add = [&](uint64_t v) {
+    words->push_back(v);
+  };
+  auto addDouble = [&](double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    add(bits);
+  };
+  auto addVector = [&](Vector v) {
+    addDouble(v.x);
+    addDouble(v.y);
+    addDouble(v.z);
+  };
+
+  add(surface.n);
+  for (SSurface &s : surface) {
+    add(s.h.v);
+    add(s.color.ToPackedIntBGRA());
+    add(s.face);
+    add(s.degm);
+    add(s.degn);
+    for (int i = 0; i <= s.degm; i++) {
+      for (int j = 0; j <= s.degn; j++) {
+        addVector(s.ctrl[i][j]);
+        addDouble(s.weight[i][j]);
+      }
+    }
+    add(s.trim.n);
+    for (const STrimBy &stb : s.trim) {
+      add(stb.curve.v);
+      add(stb.backwards);
+      addVector(stb.start);
+      addVector(stb.finish);
+    }
+  }
+
+  add(curve.n);
+  for (SCurve &c : curve) {
+    add(c.h.v);
+    add((uint64_t)c.source);
+    add(c.isExact);
+    if (c.isExact) {
+      add(c.exact.deg);
+      for (int i = 0; i <= c.exact.deg; i++) {
+        addVector(c.exact.ctrl[i]);
+        addDouble(c.exact.weight[i]);
+      }
+    }
+    add(c.pts.n);
+    for (const SCurvePt &pt : c.pts) {
+      addVector(pt.p);
+      add(pt.vertex);
+    }
+    add(c.surfA.v);
+    add(c.surfB.v);
+  }
+}
+
 void SShell::Clear() {
   for (SSurface &s : surface) {
     s.Clear();
@@ -595,4 +670,5 @@ void SShell::Clear() {
     c.Clear();
   }
   curve.Clear();
+  surfaceBvh.Clear();
 }
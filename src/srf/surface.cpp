@@ -203,6 +203,11 @@ void SSurface::GetAxisAlignedBounding(Vector *ptMax, Vector *ptMin) const {
 bool SSurface::LineEntirelyOutsideBbox(Vector a, Vector b, bool asSegment) const {
   Vector amax, amin;
   GetAxisAlignedBounding(&amax, &amin);
+  return LineEntirelyOutsideBox(amax, amin, a, b, asSegment);
+}
+
+bool SSurface::LineEntirelyOutsideBox(Vector amax, Vector amin, Vector a, Vector b,
+                                      bool asSegment) {
   if (!VectorBoundingBoxIntersectsLine(amax, amin, a, b, asSegment)) {
     // The line segment could fail to intersect the bbox, but lie entirely
     // within it and intersect the surface.
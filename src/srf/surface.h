@@ -12,6 +12,7 @@
 class SBezierList;
 class SSurface;
 class SCurvePt;
+class SPatchTree;
 
 // Utility data structure, a two-dimensional BSP to accelerate polygon
 // operations.
@@ -284,10 +285,6 @@ public:
     SBspUv          *bsp;
     SEdgeList       edges;
 
-    // For caching our initial (u, v) when doing Newton iterations to project
-    // a point into our surface.
-    Point2d         cached;
-
     static SSurface FromExtrusionOf(SBezier *spc, Vector t0, Vector t1);
     static SSurface FromRevolutionOf(SBezier *sb, Vector pt, Vector axis, double thetas,
                                      double thetaf, double dists, double distf);
@@ -307,9 +304,11 @@ public:
                                     SShell *into, SSurface::CombineAs type, int dbg_index);
     void TrimFromEdgeList(SEdgeList *el, bool asUv);
     void IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB,
-                          SShell *into);
+                          SShell *into, List<SCurve> *curves);
     void AddExactIntersectionCurve(SBezier *sb, SSurface *srfB,
-                          SShell *agnstA, SShell *agnstB, SShell *into);
+                          SShell *agnstA, SShell *agnstB, SShell *into,
+                          List<SCurve> *curves);
+    bool IntersectionCurveWithin(const List<SCurvePt> *pts, SSurface *srfB);
 
     typedef struct {
         int     tag;
@@ -324,7 +323,8 @@ public:
     void SplitInHalf(bool byU, SSurface *sa, SSurface *sb);
     void AllPointsIntersecting(Vector a, Vector b,
                                List<SInter> *l,
-                               bool asSegment, bool trimmed, bool inclTangent);
+                               bool asSegment, bool trimmed, bool inclTangent,
+                               const SPatchTree *patches=NULL);
     void AllPointsIntersectingUntrimmed(Vector a, Vector b,
                                         int *cnt, int *level,
                                         List<Inter> *l, bool asSegment,
@@ -332,6 +332,7 @@ public:
 
     void ClosestPointTo(Vector p, Point2d *puv, bool mustConverge=true);
     void ClosestPointTo(Vector p, double *u, double *v, bool mustConverge=true);
+    static void ForgetClosestPointGuesses();
     bool ClosestPointNewton(Vector p, double *u, double *v, bool mustConverge=true) const;
 
     bool PointIntersectingLine(Vector p0, Vector p1, double *u, double *v) const;
@@ -344,6 +345,8 @@ public:
     Vector NormalAt(Point2d puv) const;
     Vector NormalAt(double u, double v) const;
     bool LineEntirelyOutsideBbox(Vector a, Vector b, bool asSegment) const;
+    static bool LineEntirelyOutsideBox(Vector max, Vector min,
+                                       Vector a, Vector b, bool asSegment);
     void GetAxisAlignedBounding(Vector *ptMax, Vector *ptMin) const;
     bool CoincidentWithPlane(Vector n, double d) const;
     bool CoincidentWith(SSurface *ss, bool sameNormal) const;
@@ -377,6 +380,83 @@ public:
     void Clear();
 };
 
+// The patches that AllPointsIntersectingUntrimmed would subdivide a surface
+// into, with their bounding boxes, so that every ray cast against the same
+// surface doesn't have to split it again. Empty for surfaces that we
+// intersect in closed form, or that need too many patches. Built by the
+// first ray that needs it, so surfaces that no ray reaches cost nothing.
+class SPatchTree {
+public:
+    class Node {
+    public:
+        Vector      max, min;
+        // The children, or if left < 0 then a leaf that's close enough to
+        // flat, and the point where we start the Newton iteration.
+        int         left, right;
+        Vector      center;
+    };
+
+    std::vector<Node>   node;
+    // Rays may be cast from several threads at once.
+    std::once_flag      built;
+
+    static const int MAX_NODES = 4096;
+
+    SPatchTree() = default;
+    // It's only a cache, so copying just leaves it empty.
+    SPatchTree(const SPatchTree &) {}
+    SPatchTree &operator=(const SPatchTree &) { Clear(); return *this; }
+
+    void BuildOnce(SSurface *srf);
+    void Build(SSurface *srf);
+    int BuildNode(SSurface *srf, int level);
+    bool IsEmpty() const;
+    void Clear();
+
+    void AllPointsIntersecting(SSurface *sorig, Vector a, Vector b,
+                               List<SSurface::Inter> *l, bool asSegment) const;
+};
+
+// A bounding volume hierarchy over the surfaces of a shell, so that a
+// Boolean can find the surfaces near a ray or near another shell's surfaces
+// without testing every bounding box. It refers to surfaces by their index
+// in SShell::surface, so it's only valid until that list changes.
+class SSurfaceBvh {
+public:
+    class Node {
+    public:
+        Vector      max, min;
+        // Either two children, or (if left < 0) a leaf holding the items
+        // [first, first + count).
+        int         left, right;
+        int         first, count;
+    };
+    class Item {
+    public:
+        Vector      max, min;
+        int         surface;
+    };
+
+    std::vector<Node>   node;
+    std::vector<Item>   item;
+    // Indexed like SShell::surface.
+    std::vector<SPatchTree> patches;
+
+    static const int LEAF_SIZE = 4;
+
+    void Build(SShell *shell);
+    int BuildNode(int first, int count);
+    bool IsEmpty() const;
+    void Clear();
+
+    void OverlappingPairsWith(const SSurfaceBvh *b,
+                              std::vector<std::pair<int, int>> *pairs) const;
+    void PairsWorker(int na, const SSurfaceBvh *b, int nb,
+                     std::vector<std::pair<int, int>> *pairs) const;
+    void SurfacesAlongLine(Vector a, Vector b, bool asSegment,
+                           std::vector<int> *l) const;
+};
+
 class SShell {
 public:
     IdList<SCurve,hSCurve>      curve;
@@ -384,6 +464,9 @@ public:
 
     bool                        booleanFailed;
 
+    // Built for both operands for the duration of a Boolean.
+    SSurfaceBvh                 surfaceBvh;
+
     void MakeFromExtrusionOf(SBezierLoopSet *sbls, Vector t0, Vector t1,
                              RgbaColor color);
     bool CheckNormalAxisRelationship(SBezierLoopSet *sbls, Vector pt, Vector axis, double da, double dx);
@@ -400,6 +483,7 @@ public:
     void CopySurfacesTrimAgainst(SShell *sha, SShell *shb, SShell *into, SSurface::CombineAs type);
     void MakeIntersectionCurvesAgainst(SShell *against, SShell *into);
     void MakeClassifyingBsps(SShell *useCurvesFrom);
+    static void ClearClassifyingBspCache();
     void AllPointsIntersecting(Vector a, Vector b, List<SInter> *il,
                                 bool asSegment, bool trimmed, bool inclTangent);
     void MakeCoincidentEdgesInto(SSurface *proto, bool sameNormal,
@@ -436,5 +520,6 @@ public:
     void MakeSectionEdgesInto(Vector n, double d, SEdgeList *sel, SBezierList *sbl);
     bool IsEmpty() const;
     void RemapFaces(Group *g, int remap);
+    void ContentInto(std::vector<uint64_t> *words);
     void Clear();
 };
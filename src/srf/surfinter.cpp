@@ -10,8 +10,42 @@
 
 extern int FLAG;
 
+//-----------------------------------------------------------------------------
+// Test if a piecewise linear intersection curve between us and srfB comes
+// within both surfaces anywhere; if it lies entirely outside either of them,
+// then it's fake.
+//-----------------------------------------------------------------------------
+bool SSurface::IntersectionCurveWithin(const List<SCurvePt> *pts, SSurface *srfB) {
+  bool withinA = false, withinB = false;
+  for (const SCurvePt &scpt : *pts) {
+    double tol = 0.01;
+    Point2d puv;
+    ClosestPointTo(scpt.p, &puv);
+    if (puv.x > -tol && puv.x < 1 + tol && puv.y > -tol && puv.y < 1 + tol) {
+      withinA = true;
+    }
+    srfB->ClosestPointTo(scpt.p, &puv);
+    if (puv.x > -tol && puv.x < 1 + tol && puv.y > -tol && puv.y < 1 + tol) {
+      withinB = true;
+    }
+    // Break out early, no sense wasting time if we already have the answer.
+    if (withinA && withinB)
+      return true;
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Add an exact intersection curve between us and srfB to curves. The curves
+// already in into are only read, which is safe while the intersections of
+// other pairs of surfaces are being computed in parallel. That means a curve
+// identical to one from another pair may have been pwl'd on its own; so a
+// curve that turns out to be fake is still added, with no points, and the
+// caller decides when it merges the lists whether the other pair's pwl of it
+// is real.
+//-----------------------------------------------------------------------------
 void SSurface::AddExactIntersectionCurve(SBezier *sb, SSurface *srfB, SShell *agnstA,
-                                         SShell *agnstB, SShell *into) {
+                                         SShell *agnstB, SShell *into, List<SCurve> *curves) {
   SCurve sc = {};
   // Important to keep the order of (surfA, surfB) consistent; when we later
   // rewrite the identifiers, we rewrite surfA from A and surfB from B.
@@ -27,22 +61,19 @@ void SSurface::AddExactIntersectionCurve(SBezier *sb, SSurface *srfB, SShell *ag
   SBezier sbrev = *sb;
   sbrev.Reverse();
   bool backwards = false;
-#pragma omp critical(into)
-  {
-    for (SCurve &se : into->curve) {
-      if (se.isExact) {
-        if (sb->Equals(&(se.exact))) {
-          existing = &se;
-          break;
-        }
-        if (sbrev.Equals(&(se.exact))) {
-          existing = &se;
-          backwards = true;
-          break;
-        }
+  for (SCurve &se : into->curve) {
+    if (se.isExact) {
+      if (sb->Equals(&(se.exact))) {
+        existing = &se;
+        break;
+      }
+      if (sbrev.Equals(&(se.exact))) {
+        existing = &se;
+        backwards = true;
+        break;
       }
     }
-  } // end omp critical
+  }
   if (existing) {
     SCurvePt *v;
     for (v = existing->pts.First(); v; v = existing->pts.NextAfter(v)) {
@@ -59,28 +90,12 @@ void SSurface::AddExactIntersectionCurve(SBezier *sb, SSurface *srfB, SShell *ag
     sc.Clear();
   }
 
-  // Test if the curve lies entirely outside one of the
-  SCurvePt *scpt;
-  bool withinA = false, withinB = false;
-  for (scpt = split.pts.First(); scpt; scpt = split.pts.NextAfter(scpt)) {
-    double tol = 0.01;
-    Point2d puv;
-    ClosestPointTo(scpt->p, &puv);
-    if (puv.x > -tol && puv.x < 1 + tol && puv.y > -tol && puv.y < 1 + tol) {
-      withinA = true;
-    }
-    srfB->ClosestPointTo(scpt->p, &puv);
-    if (puv.x > -tol && puv.x < 1 + tol && puv.y > -tol && puv.y < 1 + tol) {
-      withinB = true;
-    }
-    // Break out early, no sense wasting time if we already have the answer.
-    if (withinA && withinB)
-      break;
-  }
-  if (!(withinA && withinB)) {
+  split.source = SCurve::Source::INTERSECTION;
+  if (!IntersectionCurveWithin(&(split.pts), srfB)) {
     // Intersection curve lies entirely outside one of the surfaces, so
     // it's fake.
-    split.Clear();
+    split.pts.Clear();
+    curves->Add(&split);
     return;
   }
 
@@ -100,12 +115,11 @@ void SSurface::AddExactIntersectionCurve(SBezier *sb, SSurface *srfB, SShell *ag
 #endif // 0
   ssassert(!(sb->Start()).Equals(sb->Finish()), "Unexpected zero-length edge");
 
-  split.source = SCurve::Source::INTERSECTION;
-#pragma omp critical(into)
-  { into->curve.AddAndAssignId(&split); }
+  curves->Add(&split);
 }
 
-void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SShell *into) {
+void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SShell *into,
+                                List<SCurve> *curves) {
   Vector amax, amin, bmax, bmin;
   GetAxisAlignedBounding(&amax, &amin);
   b->GetAxisAlignedBounding(&bmax, &bmin);
@@ -175,7 +189,7 @@ void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SSh
 
     if (tmax > tmin + LENGTH_EPS) {
       SBezier bezier = SBezier::From(p.Plus(dl.ScaledBy(tmin)), p.Plus(dl.ScaledBy(tmax)));
-      AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into);
+      AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into, curves);
     }
   } else if ((degm == 1 && degn == 1 && isExtdb) || (b->degm == 1 && b->degn == 1 && isExtdt)) {
     // The intersection between a plane and a surface of extrusion
@@ -218,7 +232,7 @@ void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SSh
         Vector al = along.ScaledBy(0.5);
         SBezier bezier;
         bezier = SBezier::From((si->p).Minus(al), (si->p).Plus(al));
-        AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into);
+        AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into, curves);
       }
 
       inters.Clear();
@@ -232,7 +246,7 @@ void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SSh
         bezier.ctrl[i] = VectorAtIntersectionOfPlaneAndLine(n, d, p0, p1, NULL);
       }
 
-      AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into);
+      AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into, curves);
     }
   } else if (isExtdt && isExtdb &&
              sqrt(fabs(alongt.Dot(alongb))) >
@@ -290,7 +304,7 @@ void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SSh
 
       SBezier bezier;
       bezier = SBezier::From(p.Plus(axis0), p.Plus(axis1));
-      AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into);
+      AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into, curves);
     }
 
     inters.Clear();
@@ -326,7 +340,7 @@ void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SSh
         // does it lie completely in the plane?
         if (splane->ContainsPlaneCurve(&sc)) {
           SBezier bezier = sc.exact;
-          AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into);
+          AddExactIntersectionCurve(&bezier, b, agnstA, agnstB, into, curves);
           foundExact = true;
         }
       }
@@ -404,7 +418,7 @@ void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SSh
       Vector start = spl.l[0].p, startv = spl.l[0].auxv;
       spl.l.ClearTags();
       spl.l[0].tag = 1;
-      spl.l.RemoveTagged();
+      spl.RemoveTagged();
 
       // Our chord tolerance is whatever the user specified
       double maxtol = SS.ChordTolMm();
@@ -478,13 +492,12 @@ void SSurface::IntersectAgainst(SSurface *b, SShell *agnstA, SShell *agnstB, SSh
         start = npc;
       }
 
-      spl.l.RemoveTagged();
+      spl.RemoveTagged();
 
       // And now we split and insert the curve
       SCurve split = sc.MakeCopySplitAgainst(agnstA, agnstB, this, b);
       sc.Clear();
-#pragma omp critical(into)
-      { into->curve.AddAndAssignId(&split); }
+      curves->Add(&split);
     }
     spl.Clear();
   }
@@ -231,45 +231,6 @@ haveEdge:
   return true;
 }
 
-bool SContour::IsEmptyTriangle(int ap, int bp, int cp, double scaledEPS) const {
-  STriangle tr = STriangle();
-  tr.a = l[ap].p;
-  tr.b = l[bp].p;
-  tr.c = l[cp].p;
-
-  // Accelerate with an axis-aligned bounding box test
-  Vector maxv = tr.a, minv = tr.a;
-  (tr.b).MakeMaxMin(maxv, minv);
-  (tr.c).MakeMaxMin(maxv, minv);
-
-  Vector n = Vector::From(0, 0, -1);
-
-  int i;
-  for (i = 0; i < l.n; i++) {
-    if (i == ap || i == bp || i == cp)
-      continue;
-
-    Vector p = l[i].p;
-    if (p.OutsideAndNotOn(maxv, minv))
-      continue;
-
-    // A point on the edge of the triangle is considered to be inside,
-    // and therefore makes it a non-ear; but a point on the vertex is
-    // "outside", since that's necessary to make bridges work.
-    if (p.EqualsExactly(tr.a))
-      continue;
-    if (p.EqualsExactly(tr.b))
-      continue;
-    if (p.EqualsExactly(tr.c))
-      continue;
-
-    if (tr.ContainsPointProjd(n, p)) {
-      return false;
-    }
-  }
-  return true;
-}
-
 // Test if ray b->d passes through triangle a,b,c
 static bool RayIsInside(Vector a, Vector c, Vector b, Vector d) {
   // coincident edges are not considered to intersect the triangle
@@ -294,94 +255,234 @@ static bool RayIsInside(Vector a, Vector c, Vector b, Vector d) {
   return true;
 }
 
-bool SContour::IsEar(int bp, double scaledEps) const {
-  int ap = WRAP(bp - 1, l.n), cp = WRAP(bp + 1, l.n);
+//-----------------------------------------------------------------------------
+// A contour being ear-clipped. Its points stay where they are in the list,
+// linked into a ring through prev and next, so that clipping an ear doesn't
+// shift all the points after it; and they're bucketed into a uniform grid in
+// uv, so that testing whether a triangle is empty looks only at the points
+// near it, not the whole contour. The ring keeps the points in their order
+// along the list, so the clipping visits them exactly as it did when they
+// were removed from the list one by one.
+//-----------------------------------------------------------------------------
+class SEarClipper {
+public:
+  static const int MAX_CELLS = 1024; // along each axis
+
+  List<SPoint>       *l;
+  int                 n;    // points still in the ring
+  int                 head; // the first of those along the list
+  std::vector<int>    prev, next;
+  std::vector<bool>   clipped;
+  std::vector<double> chordTol; // of each ear, once it's known to be one
+
+  int              nx, ny;
+  double           minx, miny, cellw, cellh;
+  std::vector<int> cellStart, cellItem;
+
+  void Build(List<SPoint> *pts) {
+    l    = pts;
+    n    = l->n;
+    head = 0;
+    prev.resize(n);
+    next.resize(n);
+    clipped.assign(n, false);
+    chordTol.assign(n, 0);
+
+    double maxx = VERY_NEGATIVE, maxy = VERY_NEGATIVE;
+    minx = miny = VERY_POSITIVE;
+    for (int i = 0; i < n; i++) {
+      prev[i]  = WRAP(i - 1, n);
+      next[i]  = WRAP(i + 1, n);
+      Vector p = (*l)[i].p;
+      minx     = std::min(minx, p.x);
+      maxx     = std::max(maxx, p.x);
+      miny     = std::min(miny, p.y);
+      maxy     = std::max(maxy, p.y);
+    }
 
-  STriangle tr = STriangle();
-  tr.a = l[ap].p;
-  tr.b = l[bp].p;
-  tr.c = l[cp].p;
+    // About one point per cell.
+    nx = (int)ceil(sqrt((double)n));
+    if (nx < 1)
+      nx = 1;
+    if (nx > MAX_CELLS)
+      nx = MAX_CELLS;
+    ny    = nx;
+    cellw = std::max((maxx - minx) / nx, LENGTH_EPS);
+    cellh = std::max((maxy - miny) / ny, LENGTH_EPS);
+
+    cellStart.assign(nx * ny + 1, 0);
+    for (int i = 0; i < n; i++) {
+      cellStart[CellOf((*l)[i].p) + 1]++;
+    }
+    for (int c = 0; c < nx * ny; c++) {
+      cellStart[c + 1] += cellStart[c];
+    }
+    cellItem.resize(n);
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < n; i++) {
+      cellItem[fill[CellOf((*l)[i].p)]++] = i;
+    }
+  }
 
-  if ((tr.a).Equals(tr.c)) {
-    // This is two coincident and anti-parallel edges. Zero-area, so
-    // won't generate a real triangle, but we certainly can clip it.
-    return true;
+  static int Clamp(double c, int cells) {
+    if (c < 0)
+      return 0;
+    if (c > cells - 1)
+      return cells - 1;
+    return (int)c;
+  }
+  int CellX(double x) const {
+    return Clamp(floor((x - minx) / cellw), nx);
+  }
+  int CellY(double y) const {
+    return Clamp(floor((y - miny) / cellh), ny);
+  }
+  int CellOf(Vector p) const {
+    return CellY(p.y) * nx + CellX(p.x);
   }
 
-  Vector n = Vector::From(0, 0, -1);
-  if ((tr.Normal()).Dot(n) < scaledEps) {
-    // This vertex is reflex, or between two collinear edges; either way,
-    // it's not an ear.
-    return false;
+  // Call fn with each point still in the ring that might not be
+  // OutsideAndNotOn() the box; stop, and return false, as soon as fn does.
+  template<class F>
+  bool ForEachPointNear(Vector maxv, Vector minv, F fn) const {
+    int x0 = CellX(minv.x - LENGTH_EPS), x1 = CellX(maxv.x + LENGTH_EPS),
+        y0 = CellY(minv.y - LENGTH_EPS), y1 = CellY(maxv.y + LENGTH_EPS);
+    for (int cy = y0; cy <= y1; cy++) {
+      for (int cx = x0; cx <= x1; cx++) {
+        int c = cy * nx + cx;
+        for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+          int i = cellItem[k];
+          if (clipped[i])
+            continue;
+          if (!fn(i))
+            return false;
+        }
+      }
+    }
+    return true;
   }
 
-  // Accelerate with an axis-aligned bounding box test
-  Vector maxv = tr.a, minv = tr.a;
-  (tr.b).MakeMaxMin(maxv, minv);
-  (tr.c).MakeMaxMin(maxv, minv);
+  bool IsEmptyTriangle(int ap, int bp, int cp, double scaledEPS) const {
+    STriangle tr = STriangle();
+    tr.a         = (*l)[ap].p;
+    tr.b         = (*l)[bp].p;
+    tr.c         = (*l)[cp].p;
+
+    // Accelerate with an axis-aligned bounding box test
+    Vector maxv = tr.a, minv = tr.a;
+    (tr.b).MakeMaxMin(maxv, minv);
+    (tr.c).MakeMaxMin(maxv, minv);
+
+    Vector n = Vector::From(0, 0, -1);
+
+    return ForEachPointNear(maxv, minv, [&](int i) {
+      if (i == ap || i == bp || i == cp)
+        return true;
+
+      Vector p = (*l)[i].p;
+      if (p.OutsideAndNotOn(maxv, minv))
+        return true;
+
+      // A point on the edge of the triangle is considered to be inside,
+      // and therefore makes it a non-ear; but a point on the vertex is
+      // "outside", since that's necessary to make bridges work.
+      if (p.EqualsExactly(tr.a))
+        return true;
+      if (p.EqualsExactly(tr.b))
+        return true;
+      if (p.EqualsExactly(tr.c))
+        return true;
+
+      return !tr.ContainsPointProjd(n, p);
+    });
+  }
 
-  int i;
-  for (i = 0; i < l.n; i++) {
-    if (i == ap || i == bp || i == cp)
-      continue;
+  bool IsEar(int bp, double scaledEps) const {
+    int ap = prev[bp], cp = next[bp];
 
-    Vector p = l[i].p;
-    if (p.OutsideAndNotOn(maxv, minv))
-      continue;
+    STriangle tr = STriangle();
+    tr.a         = (*l)[ap].p;
+    tr.b         = (*l)[bp].p;
+    tr.c         = (*l)[cp].p;
 
-    // A point on the edge of the triangle is considered to be inside,
-    // and therefore makes it a non-ear; but a point on the vertex is
-    // "outside", since that's necessary to make bridges work.
-    if (p.EqualsExactly(tr.a))
-      continue;
-    if (p.EqualsExactly(tr.c))
-      continue;
-    // points coincident with bp have to be allowed for bridges but edges
-    // from that other point must not cross through our triangle.
-    if (p.EqualsExactly(tr.b)) {
-      int j = WRAP(i - 1, l.n);
-      int k = WRAP(i + 1, l.n);
-      Vector jp = l[j].p;
-      Vector kp = l[k].p;
-
-      // two consecutive bridges (A,B,C) and later (C,B,A) are not an ear
-      if (jp.Equals(tr.c) && kp.Equals(tr.a))
-        return false;
-      // check both edges from the point in question
-      if (!RayIsInside(tr.a, tr.c, p, jp) && !RayIsInside(tr.a, tr.c, p, kp))
-        continue;
+    if ((tr.a).Equals(tr.c)) {
+      // This is two coincident and anti-parallel edges. Zero-area, so
+      // won't generate a real triangle, but we certainly can clip it.
+      return true;
     }
 
-    if (tr.ContainsPointProjd(n, p)) {
+    Vector n = Vector::From(0, 0, -1);
+    if ((tr.Normal()).Dot(n) < scaledEps) {
+      // This vertex is reflex, or between two collinear edges; either way,
+      // it's not an ear.
       return false;
     }
-  }
-  return true;
-}
 
-void SContour::ClipEarInto(SMesh *m, int bp, double scaledEps) {
-  int ap = WRAP(bp - 1, l.n), cp = WRAP(bp + 1, l.n);
+    // Accelerate with an axis-aligned bounding box test
+    Vector maxv = tr.a, minv = tr.a;
+    (tr.b).MakeMaxMin(maxv, minv);
+    (tr.c).MakeMaxMin(maxv, minv);
+
+    return ForEachPointNear(maxv, minv, [&](int i) {
+      if (i == ap || i == bp || i == cp)
+        return true;
+
+      Vector p = (*l)[i].p;
+      if (p.OutsideAndNotOn(maxv, minv))
+        return true;
+
+      // A point on the edge of the triangle is considered to be inside,
+      // and therefore makes it a non-ear; but a point on the vertex is
+      // "outside", since that's necessary to make bridges work.
+      if (p.EqualsExactly(tr.a))
+        return true;
+      if (p.EqualsExactly(tr.c))
+        return true;
+      // points coincident with bp have to be allowed for bridges but edges
+      // from that other point must not cross through our triangle.
+      if (p.EqualsExactly(tr.b)) {
+        Vector jp = (*l)[prev[i]].p;
+        Vector kp = (*l)[next[i]].p;
+
+        // two consecutive bridges (A,B,C) and later (C,B,A) are not an ear
+        if (jp.Equals(tr.c) && kp.Equals(tr.a))
+          return false;
+        // check both edges from the point in question
+        if (!RayIsInside(tr.a, tr.c, p, jp) && !RayIsInside(tr.a, tr.c, p, kp))
+          return true;
+      }
 
-  STriangle tr = STriangle();
-  tr.a = l[ap].p;
-  tr.b = l[bp].p;
-  tr.c = l[cp].p;
-  if (tr.Normal().MagSquared() < scaledEps * scaledEps) {
-    // A vertex with more than two edges will cause us to generate
-    // zero-area triangles, which must be culled.
-  } else {
-    m->AddTriangle(&tr);
+      return !tr.ContainsPointProjd(n, p);
+    });
   }
 
-  // By deleting the point at bp, we may change the ear-ness of the points
-  // on either side.
-  l[ap].ear = EarType::UNKNOWN;
-  l[cp].ear = EarType::UNKNOWN;
+  void ClipEarInto(SMesh *m, int bp, double scaledEps) {
+    int ap = prev[bp], cp = next[bp];
+
+    STriangle tr = STriangle();
+    tr.a         = (*l)[ap].p;
+    tr.b         = (*l)[bp].p;
+    tr.c         = (*l)[cp].p;
+    if (tr.Normal().MagSquared() < scaledEps * scaledEps) {
+      // A vertex with more than two edges will cause us to generate
+      // zero-area triangles, which must be culled.
+    } else {
+      m->AddTriangle(&tr);
+    }
 
-  l.ClearTags();
-  l[bp].tag = 1;
-  l.RemoveTagged();
-}
+    // By deleting the point at bp, we may change the ear-ness of the points
+    // on either side.
+    (*l)[ap].ear = EarType::UNKNOWN;
+    (*l)[cp].ear = EarType::UNKNOWN;
+
+    next[ap]    = cp;
+    prev[cp]    = ap;
+    clipped[bp] = true;
+    n--;
+    if (bp == head)
+      head = cp;
+  }
+};
 
 void SContour::UvTriangulateInto(SMesh *m, SSurface *srf) {
   Vector tu, tv;
@@ -408,8 +509,15 @@ void SContour::UvTriangulateInto(SMesh *m, SSurface *srf) {
   }
   l.RemoveTagged();
 
+  bool planar = (srf->degm == 1 && srf->degn == 1);
+
   // Handle simple triangle fans all at once. This pass is optional.
-  if (srf->degm == 1 && srf->degn == 1) {
+  if (planar) {
+    // Nothing is clipped during this pass, the fans' points are just
+    // tagged and removed at the end, so every test sees the whole contour.
+    SEarClipper fan;
+    fan.Build(&l);
+
     l.ClearTags();
     int j = 0;
     int pstart = 0;
@@ -435,10 +543,10 @@ void SContour::UvTriangulateInto(SMesh *m, SSurface *srf) {
       if (slen < oldspan)
         end = true;
 
-      if (!IsEar(i - 1, scaledEps))
+      if (!fan.IsEar(i - 1, scaledEps))
         end = true;
       //            if ((j>0) && !IsEar(pstart, i-1, i, scaledEps)) end = true;
-      if ((j > 0) && !IsEmptyTriangle(pstart, i - 1, i, scaledEps))
+      if ((j > 0) && !fan.IsEmptyTriangle(pstart, i - 1, i, scaledEps))
         end = true;
       // the new segment is valid so add to the fan
       if (!end) {
@@ -477,21 +585,29 @@ void SContour::UvTriangulateInto(SMesh *m, SSurface *srf) {
     l.RemoveTagged();
   } // end optional fan creation pass
 
+  SEarClipper ec;
+  ec.Build(&l);
+
   bool toggle = false;
-  while (l.n > 3) {
+  while (ec.n > 3) {
     int bestEar = -1;
     double bestChordTol = VERY_POSITIVE;
     // Alternate the starting position so we generate strip-like
     // triangulations instead of fan-like
     toggle = !toggle;
-    int offset = toggle ? -1 : 0;
-    for (i = 0; i < l.n; i++) {
-      int ear = WRAP(i + offset, l.n);
+    int ear = toggle ? ec.prev[ec.head] : ec.head;
+    for (i = 0; i < ec.n; i++, ear = ec.next[ear]) {
       if (l[ear].ear == EarType::UNKNOWN) {
-        (l[ear]).ear = IsEar(ear, scaledEps) ? EarType::EAR : EarType::NOT_EAR;
+        (l[ear]).ear = ec.IsEar(ear, scaledEps) ? EarType::EAR : EarType::NOT_EAR;
+        if (l[ear].ear == EarType::EAR && !planar) {
+          // This depends only on the neighbours, and they change only
+          // when one of them is clipped, which resets us to UNKNOWN.
+          Vector prev = l[ec.prev[ear]].p, next = l[ec.next[ear]].p;
+          ec.chordTol[ear] = srf->ChordToleranceForEdge(prev, next);
+        }
       }
       if (l[ear].ear == EarType::EAR) {
-        if (srf->degm == 1 && srf->degn == 1) {
+        if (planar) {
           // This is a plane; any ear is a good ear.
           bestEar = ear;
           break;
@@ -499,8 +615,7 @@ void SContour::UvTriangulateInto(SMesh *m, SSurface *srf) {
         // If we are triangulating a curved surface, then try to
         // clip ears that have a small chord tolerance from the
         // surface.
-        Vector prev = l[WRAP((i + offset - 1), l.n)].p, next = l[WRAP((i + offset + 1), l.n)].p;
-        double tol = srf->ChordToleranceForEdge(prev, next);
+        double tol = ec.chordTol[ear];
         if (tol < bestChordTol - scaledEps) {
           bestEar = ear;
           bestChordTol = tol;
@@ -514,10 +629,10 @@ void SContour::UvTriangulateInto(SMesh *m, SSurface *srf) {
       dbp("couldn't find an ear! fail");
       return;
     }
-    ClipEarInto(m, bestEar, scaledEps);
+    ec.ClipEarInto(m, bestEar, scaledEps);
   }
 
-  ClipEarInto(m, 0, scaledEps); // add the last triangle
+  ec.ClipEarInto(m, ec.head, scaledEps); // add the last triangle
 }
 
 double SSurface::ChordToleranceForEdge(Vector a, Vector b) const {
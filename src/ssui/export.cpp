@@ -398,22 +398,22 @@ void SolveSpaceUI::ExportLinesAndMesh(SEdgeList *sel, SBezierList *sbl, SMesh *s
                                  GW.showOutlines ? Style::OUTLINE : Style::SOLID_EDGE);
     }
 
-    root->ClearTags();
-    int cnt = 1234;
-
-    SEdge *se;
-    for (se = sel->l.First(); se; se = sel->l.NextAfter(se)) {
+    // The edges are tested independently of each other, so split them up
+    // across threads, and then collect the results in their original order.
+    std::vector<SEdgeList> tested(sel->l.n);
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < sel->l.n; i++) {
+      const SEdge *se = &sel->l[i];
       if (se->auxA == Style::CONSTRAINT) {
         // Constraints should not get hidden line removed; they're
         // always on top.
-        hlrd.AddEdge(se->a, se->b, se->auxA);
         continue;
       }
 
-      SEdgeList edges = {};
+      SEdgeList &edges = tested[i];
       // Split the original edge against the mesh
       edges.AddEdge(se->a, se->b, se->auxA);
-      root->OcclusionTestLine(*se, &edges, cnt);
+      root->OcclusionTestLine(*se, &edges);
       if (SS.GW.drawOccludedAs == GraphicsWindow::DrawOccludedAs::STIPPLED) {
         for (SEdge &se : edges.l) {
           if (se.tag == 1) {
@@ -426,13 +426,20 @@ void SolveSpaceUI::ExportLinesAndMesh(SEdgeList *sel, SBezierList *sbl, SMesh *s
 
       // the occlusion test splits unnecessarily; so fix those
       edges.MergeCollinearSegments(se->a, se->b);
-      cnt++;
+    }
+
+    for (int i = 0; i < sel->l.n; i++) {
+      SEdge *se = &sel->l[i];
+      if (se->auxA == Style::CONSTRAINT) {
+        hlrd.AddEdge(se->a, se->b, se->auxA);
+        continue;
+      }
       // And add the results to our output
       SEdge *sen;
-      for (sen = edges.l.First(); sen; sen = edges.l.NextAfter(sen)) {
+      for (sen = tested[i].l.First(); sen; sen = tested[i].l.NextAfter(sen)) {
         hlrd.AddEdge(sen->a, sen->b, sen->auxA);
       }
-      edges.Clear();
+      tested[i].Clear();
     }
 
     sel = &hlrd;
@@ -15,16 +15,30 @@ void SolveSpaceUI::MarkGroupDirtyByEntity(hEntity he) {
 }
 
 void SolveSpaceUI::MarkGroupDirty(hGroup hg, bool onlyThis) {
-  bool go = false;
-  for (auto const &gh : SK.groupOrder) {
-    Group *g = SK.GetGroup(gh);
-    if (g->h == hg) {
-      go = true;
-    }
-    if (go) {
-      g->clean = false;
-      if (onlyThis)
-        break;
+  SK.GetGroup(hg)->clean = false;
+  if (!onlyThis) {
+    // Everything downstream of a dirty group has to be solved again too;
+    // the rest can stay as it is.
+    std::map<uint32_t, std::vector<hGroup>> deps;
+    SK.FindGroupDependencies(&deps);
+    bool go = false;
+    for (auto const &gh : SK.groupOrder) {
+      Group *g = SK.GetGroup(gh);
+      if (g->h == hg) {
+        go = true;
+        continue;
+      }
+      if (!go || !g->clean)
+        continue;
+      auto it = deps.find(gh.v);
+      if (it == deps.end())
+        continue;
+      for (hGroup dep : it->second) {
+        if (!SK.GetGroup(dep)->clean) {
+          g->clean = false;
+          break;
+        }
+      }
     }
   }
   unsaved = true;
@@ -93,30 +107,31 @@ bool SolveSpaceUI::PruneGroups(hGroup hg) {
 }
 
 bool SolveSpaceUI::PruneRequests(hGroup hg) {
-  auto e = std::find_if(SK.entity.begin(), SK.entity.end(),
-                        [&](Entity &e) { return e.group == hg && !EntityExists(e.workplane); });
-  if (e != SK.entity.end()) {
+  std::vector<Entity *> entities;
+  SK.EntitiesInGroup(hg, &entities);
+  auto e = std::find_if(entities.begin(), entities.end(),
+                        [&](Entity *e) { return !EntityExists(e->workplane); });
+  if (e != entities.end()) {
     (deleted.requests)++;
-    SK.entity.RemoveById(e->h);
+    SK.entity.RemoveById((*e)->h);
     return true;
   }
   return false;
 }
 
 bool SolveSpaceUI::PruneConstraints(hGroup hg) {
-  auto c = std::find_if(SK.constraint.begin(), SK.constraint.end(), [&](Constraint &c) {
-    if (c.group != hg)
-      return false;
-
-    if (EntityExists(c.workplane) && EntityExists(c.ptA) && EntityExists(c.ptB) &&
-        EntityExists(c.entityA) && EntityExists(c.entityB) && EntityExists(c.entityC) &&
-        EntityExists(c.entityD)) {
-      return false;
+  Constraint *c = NULL;
+  for (hConstraint hc : SK.ItemsInGroup(hg).constraint) {
+    Constraint *ci = SK.GetConstraint(hc);
+    if (!(EntityExists(ci->workplane) && EntityExists(ci->ptA) && EntityExists(ci->ptB) &&
+          EntityExists(ci->entityA) && EntityExists(ci->entityB) && EntityExists(ci->entityC) &&
+          EntityExists(ci->entityD))) {
+      c = ci;
+      break;
     }
-    return true;
-  });
+  }
 
-  if (c != SK.constraint.end()) {
+  if (c != NULL) {
     (deleted.constraints)++;
     if (c->type != Constraint::Type::POINTS_COINCIDENT && c->type != Constraint::Type::HORIZONTAL &&
         c->type != Constraint::Type::VERTICAL) {
@@ -129,7 +144,7 @@ bool SolveSpaceUI::PruneConstraints(hGroup hg) {
   return false;
 }
 
-void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree, bool genForBBox) {
+void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree) {
   int first = 0, last = 0, i;
 
   uint64_t startMillis = GetMilliseconds(), endMillis;
@@ -191,16 +206,6 @@ void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree, bool genForBBox)
   }
   }
 
-  // If we're generating entities for display, first we need to find
-  // the bounding box to turn relative chord tolerance to absolute.
-  if (!SS.exportMode && !genForBBox) {
-    GenerateAll(type, andFindFree, /*genForBBox=*/true);
-    BBox box = SK.CalculateEntityBBox(/*includeInvisibles=*/true);
-    Vector size = box.maxp.Minus(box.minp);
-    double maxSize = std::max({size.x, size.y, size.z});
-    chordTolCalculated = maxSize * chordTol / 100.0;
-  }
-
   // Remove any requests or constraints that refer to a nonexistent
   // group; can check those immediately, since we know what the list
   // of groups should be.
@@ -215,6 +220,11 @@ void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree, bool genForBBox)
   SK.entity.Clear();
   SK.entity.ReserveMore(oldEntityCount);
 
+  // Which groups get solved, and which get their meshes regenerated
+  std::vector<char> solveGroup(SK.groupOrder.n, false);
+  std::vector<char> meshGroup(SK.groupOrder.n, false);
+  std::set<uint32_t> meshChanged;
+
   // Not using range-for because we're using the index inside the loop.
   for (i = 0; i < SK.groupOrder.n; i++) {
     hGroup hg = SK.groupOrder[i];
@@ -225,19 +235,16 @@ void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree, bool genForBBox)
     if (PruneGroups(hg))
       goto pruned;
 
-    int groupRequestIndex = 0;
-    for (auto &req : SK.request) {
-      Request *r = &req;
-      if (r->group != hg)
-        continue;
+    const Sketch::GroupItems &items = SK.ItemsInGroup(hg);
+    int                       groupRequestIndex = 0;
+    for (hRequest hr : items.request) {
+      Request *r = SK.GetRequest(hr);
       r->groupRequestIndex = groupRequestIndex++;
 
       r->Generate(&(SK.entity), &(SK.param));
     }
-    for (auto &con : SK.constraint) {
-      Constraint *c = &con;
-      if (c->group != hg)
-        continue;
+    for (hConstraint hc : items.constraint) {
+      Constraint *c = SK.GetConstraint(hc);
 
       c->Generate(&(SK.param));
     }
@@ -268,22 +275,31 @@ void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree, bool genForBBox)
       g->solved.how = SolveResult::OKAY;
       g->clean = true;
     } else {
+      // Within the range, a group that is clean and solved okay doesn't
+      // depend on anything that changed, so it needn't be solved again;
+      // but its mesh still has to be redone if the mesh it builds on was.
+      Group *g = SK.GetGroup(hg);
+      bool   inRange = (i >= first && i <= last);
+      solveGroup[i] = inRange && (type != Generate::DIRTY || !g->clean || !g->IsSolvedOkay());
+      meshGroup[i] = solveGroup[i];
+      if (inRange && !meshGroup[i]) {
+        Group *pg = g->RunningMeshGroup();
+        meshGroup[i] =
+            (pg && meshChanged.count(pg->h.v)) || (g->opA.v && meshChanged.count(g->opA.v));
+      }
+      if (meshGroup[i])
+        meshChanged.insert(hg.v);
+
       // this i is an index in groupOrder
-      if (i >= first && i <= last) {
-        // The group falls inside the range, so really solve it,
-        // and then regenerate the mesh based on the solved stuff.
-        Group *g = SK.GetGroup(hg);
-        if (genForBBox) {
-          SolveGroupAndReport(hg, andFindFree);
-          g->GenerateLoops();
-        } else {
-          g->GenerateShellAndMesh();
-          g->clean = true;
-        }
+      if (solveGroup[i] && !SS.exportMode) {
+        // The group falls inside the range, so really solve it; its mesh
+        // gets regenerated below, once we know the chord tolerance.
+        SolveGroupAndReport(hg, andFindFree);
+        g->GenerateLoops();
       } else {
-        // The group falls outside the range, so just assume that
-        // it's good wherever we left it. The mesh is unchanged,
-        // and the parameters must be marked as known.
+        // The group falls outside the range, or nothing that it depends
+        // on changed, so just assume that it's good wherever we left it.
+        // The parameters must be marked as known.
         for (auto &p : SK.param) {
           Param *newp = &p;
 
@@ -295,6 +311,24 @@ void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree, bool genForBBox)
     }
   }
 
+  // If we're generating entities for display, we need the bounding box of
+  // everything we just solved to turn relative chord tolerance to absolute.
+  if (!SS.exportMode) {
+    BBox box = SK.CalculateEntityBBox(/*includeInvisibles=*/true);
+    Vector size = box.maxp.Minus(box.minp);
+    double maxSize = std::max({size.x, size.y, size.z});
+    chordTolCalculated = maxSize * chordTol / 100.0;
+  }
+
+  // And now regenerate the meshes based on the solved stuff.
+  for (i = 0; i < SK.groupOrder.n; i++) {
+    if (!meshGroup[i])
+      continue;
+    Group *g = SK.GetGroup(SK.groupOrder[i]);
+    g->GenerateShellAndMesh();
+    g->clean = true;
+  }
+
   // And update any reference dimensions with their new values
   for (auto &con : SK.constraint) {
     Constraint *c = &con;
@@ -372,8 +406,7 @@ void SolveSpaceUI::GenerateAll(Generate type, bool andFindFree, bool genForBBox)
     case Generate::UNTIL_ACTIVE: typeStr = "UNTIL_ACTIVE"; break;
     }
     if (endMillis)
-      dbp("Generate::%s%s took %lld ms", typeStr, (genForBBox ? " (for bounding box)" : ""),
-          GetMilliseconds() - startMillis);
+      dbp("Generate::%s took %lld ms", typeStr, GetMilliseconds() - startMillis);
   }
 
   return;
@@ -383,7 +416,7 @@ pruned:
   SK.param.Clear();
   prev.MoveSelfInto(&(SK.param));
   // Try again
-  GenerateAll(type, andFindFree, genForBBox);
+  GenerateAll(type, andFindFree);
 }
 
 void SolveSpaceUI::ForceReferences() {
@@ -441,8 +474,8 @@ void SolveSpaceUI::UpdateCenterOfMass() {
   SS.centerOfMass.dirty = false;
 }
 
-void SolveSpaceUI::MarkDraggedParams() {
-  sys.dragged.Clear();
+void SolveSpaceUI::MarkDraggedParams(System *s) {
+  s->dragged.Clear();
 
   for (int i = -1; i < SS.GW.pending.points.n; i++) {
     hEntity hp;
@@ -463,14 +496,14 @@ void SolveSpaceUI::MarkDraggedParams() {
       case Entity::Type::POINT_N_TRANS:
       case Entity::Type::POINT_IN_3D:
       case Entity::Type::POINT_N_ROT_AXIS_TRANS:
-        sys.dragged.Add(&(pt->param[0]));
-        sys.dragged.Add(&(pt->param[1]));
-        sys.dragged.Add(&(pt->param[2]));
+        s->dragged.Add(&(pt->param[0]));
+        s->dragged.Add(&(pt->param[1]));
+        s->dragged.Add(&(pt->param[2]));
         break;
 
       case Entity::Type::POINT_IN_2D:
-        sys.dragged.Add(&(pt->param[0]));
-        sys.dragged.Add(&(pt->param[1]));
+        s->dragged.Add(&(pt->param[0]));
+        s->dragged.Add(&(pt->param[1]));
         break;
 
       default: // Only the entities above can be dragged.
@@ -483,7 +516,7 @@ void SolveSpaceUI::MarkDraggedParams() {
     if (circ) {
       Entity *dist = SK.GetEntity(circ->distance);
       switch (dist->type) {
-      case Entity::Type::DISTANCE: sys.dragged.Add(&(dist->param[0])); break;
+      case Entity::Type::DISTANCE: s->dragged.Add(&(dist->param[0])); break;
 
       default: // Only the entities above can be dragged.
         break;
@@ -495,10 +528,10 @@ void SolveSpaceUI::MarkDraggedParams() {
     if (norm) {
       switch (norm->type) {
       case Entity::Type::NORMAL_IN_3D:
-        sys.dragged.Add(&(norm->param[0]));
-        sys.dragged.Add(&(norm->param[1]));
-        sys.dragged.Add(&(norm->param[2]));
-        sys.dragged.Add(&(norm->param[3]));
+        s->dragged.Add(&(norm->param[0]));
+        s->dragged.Add(&(norm->param[1]));
+        s->dragged.Add(&(norm->param[2]));
+        s->dragged.Add(&(norm->param[3]));
         break;
 
       default: // Only the entities above can be dragged.
@@ -519,50 +552,139 @@ void SolveSpaceUI::SolveGroupAndReport(hGroup hg, bool andFindFree) {
   }
 }
 
-void SolveSpaceUI::WriteEqSystemForGroup(hGroup hg) {
+void SolveSpaceUI::WriteEqSystemForGroup(hGroup hg, System *s) {
   // Clear out the system to be solved.
-  sys.entity.Clear();
-  sys.param.Clear();
-  sys.eq.Clear();
+  s->entity.Clear();
+  s->param.Clear();
+  s->eq.Clear();
   // And generate all the params for requests in this group
-  for (auto &req : SK.request) {
-    Request *r = &req;
-    if (r->group != hg)
-      continue;
+  const Sketch::GroupItems &items = SK.ItemsInGroup(hg);
+  for (hRequest hr : items.request) {
+    Request *r = SK.GetRequest(hr);
 
-    r->Generate(&(sys.entity), &(sys.param));
+    r->Generate(&(s->entity), &(s->param));
   }
-  for (auto &con : SK.constraint) {
-    Constraint *c = &con;
-    if (c->group != hg)
-      continue;
+  for (hConstraint hc : items.constraint) {
+    Constraint *c = SK.GetConstraint(hc);
 
-    c->Generate(&(sys.param));
+    c->Generate(&(s->param));
   }
   // And for the group itself
   Group *g = SK.GetGroup(hg);
-  g->Generate(&(sys.entity), &(sys.param));
+  g->Generate(&(s->entity), &(s->param));
   // Set the initial guesses for all the params
-  for (auto &param : sys.param) {
+  for (auto &param : s->param) {
     Param *p = &param;
     p->known = false;
     p->val = SK.GetParam(p->h)->val;
   }
 
-  MarkDraggedParams();
+  MarkDraggedParams(s);
+}
+
+static bool IsDraggingParams(GraphicsWindow::Pending operation) {
+  switch (operation) {
+  case GraphicsWindow::Pending::DRAGGING_POINTS:
+  case GraphicsWindow::Pending::DRAGGING_NEW_POINT:
+  case GraphicsWindow::Pending::DRAGGING_NEW_LINE_POINT:
+  case GraphicsWindow::Pending::DRAGGING_NEW_CUBIC_POINT:
+  case GraphicsWindow::Pending::DRAGGING_NEW_ARC_POINT:
+  case GraphicsWindow::Pending::DRAGGING_RADIUS:
+  case GraphicsWindow::Pending::DRAGGING_NORMAL:
+  case GraphicsWindow::Pending::DRAGGING_NEW_RADIUS: return true;
+
+  default: return false;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// A hash of everything that goes into the equations for a group, other than
+// the values of its own params: the requests and constraints in it, what's
+// being dragged, and the params that earlier groups have already solved for,
+// which get written into the equations as constants.
+//-----------------------------------------------------------------------------
+uint64_t SolveSpaceUI::DragSessionKey(hGroup hg) {
+  uint64_t key = HASH_SEED;
+  auto add = [&](uint64_t v) {
+    key = HashMix(key, v);
+  };
+  auto addDouble = [&](double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    add(bits);
+  };
+
+  add(hg.v);
+  const Sketch::GroupItems &items = SK.ItemsInGroup(hg);
+  for (hRequest hr : items.request) {
+    add(hr.v);
+  }
+  for (hConstraint hc : items.constraint) {
+    Constraint *c = SK.GetConstraint(hc);
+    add(c->h.v);
+    add((uint64_t)c->type);
+    add(c->reference);
+    add(c->other);
+    add(c->other2);
+    addDouble(c->valA);
+  }
+  add(GW.pending.point.v);
+  for (hEntity &he : GW.pending.points) {
+    add(he.v);
+  }
+  add(GW.pending.circle.v);
+  add(GW.pending.normal.v);
+  for (auto &param : SK.param) {
+    if (!param.known)
+      continue;
+    add(param.h.v);
+    addDouble(param.val);
+  }
+  return key;
+}
+
+void SolveSpaceUI::EndDragSession() {
+  dragSession.sys.reset();
+  dragSession.group = {};
 }
 
 void SolveSpaceUI::SolveGroup(hGroup hg, bool andFindFree) {
-  WriteEqSystemForGroup(hg);
   Group *g = SK.GetGroup(hg);
+  System *s = &sys;
+
+  // Drags only move params, so while one is in progress the active group's
+  // equations and Jacobian can be kept, and solving is just Newton from the
+  // last solution.
+  if (!andFindFree && hg == GW.activeGroup && IsDraggingParams(GW.pending.operation)) {
+    uint64_t key = DragSessionKey(hg);
+    if (dragSession.sys && dragSession.group == hg && dragSession.key == key) {
+      if (dragSession.sys->SolveAgain()) {
+        g->solved.how = SolveResult::OKAY;
+        FreeAllTemporary();
+        return;
+      }
+    }
+    dragSession.sys.reset(new System());
+    dragSession.group = hg;
+    dragSession.key = key;
+    s = dragSession.sys.get();
+  } else if (dragSession.sys && hg == dragSession.group) {
+    EndDragSession();
+  }
+
+  WriteEqSystemForGroup(hg, s);
   g->solved.remove.Clear();
   g->solved.findToFixTimeout = SS.timeoutRedundantConstr;
-  SolveResult how = sys.Solve(g, NULL, &(g->solved.dof), &(g->solved.remove),
-                              /*andFindBad=*/!g->allowRedundant,
-                              /*andFindFree=*/andFindFree,
-                              /*forceDofCheck=*/!g->dofCheckOk);
+  SolveResult how = s->Solve(g, NULL, &(g->solved.dof), &(g->solved.remove),
+                             /*andFindBad=*/!g->allowRedundant,
+                             /*andFindFree=*/andFindFree,
+                             /*forceDofCheck=*/!g->dofCheckOk);
   if (how == SolveResult::OKAY) {
     g->dofCheckOk = true;
+  } else if (s != &sys) {
+    // Only a system that solved cleanly can be solved again; anything
+    // else has to be diagnosed from scratch each time.
+    EndDragSession();
   }
   g->solved.how = how;
   FreeAllTemporary();
@@ -574,7 +696,7 @@ SolveResult SolveSpaceUI::TestRankForGroup(hGroup hg, int *rank) {
   // no point to solve rank because this result is not meaningful
   if (g->suppressDofCalculation || g->allowRedundant)
     return SolveResult::OKAY;
-  WriteEqSystemForGroup(hg);
+  WriteEqSystemForGroup(hg, &sys);
   SolveResult result = sys.SolveRank(g, rank);
   FreeAllTemporary();
   return result;
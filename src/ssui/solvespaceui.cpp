@@ -278,7 +278,7 @@ void SolveSpaceUI::Exit() {
 void SolveSpaceUI::Refresh() {
   // generateAll must happen bfore updating displays
   if (scheduledGenerateAll) {
-    GenerateAll(Generate::DIRTY, /*andFindFree=*/false, /*genForBBox=*/false);
+    GenerateAll(Generate::DIRTY, /*andFindFree=*/false);
     scheduledGenerateAll = false;
   }
 /*
@@ -601,6 +601,9 @@ void SolveSpaceUI::ShowNakedEdges(bool reportOnlyWhenNotOkay) {
 
 void SolveSpaceUI::Clear() {
   sys.Clear();
+  EndDragSession();
+  Group::ClearBooleanCache();
+  SShell::ClearClassifyingBspCache();
   for (int i = 0; i < MAX_UNDO; i++) {
     if (i < undo.cnt)
       undo.d[i].Clear();
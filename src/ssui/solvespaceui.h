@@ -259,13 +259,12 @@ public:
     UNTIL_ACTIVE,
   };
 
-  void        GenerateAll(Generate type = Generate::DIRTY, bool andFindFree = false,
-                          bool genForBBox = false);
+  void        GenerateAll(Generate type = Generate::DIRTY, bool andFindFree = false);
   void        SolveGroup(hGroup hg, bool andFindFree);
   void        SolveGroupAndReport(hGroup hg, bool andFindFree);
   SolveResult TestRankForGroup(hGroup hg, int *rank = NULL);
-  void        WriteEqSystemForGroup(hGroup hg);
-  void        MarkDraggedParams();
+  void        WriteEqSystemForGroup(hGroup hg, System *s);
+  void        MarkDraggedParams(System *s);
   void        ForceReferences();
   void        UpdateCenterOfMass();
 
@@ -275,6 +274,18 @@ public:
   System *pSys;
   System &sys;
 
+  // While something is being dragged, the system for the active group is
+  // kept from one mouse move to the next, so that each move only has to
+  // re-run Newton from the last solution. The key changes whenever anything
+  // but the dragged params could have changed the equations.
+  struct {
+    std::unique_ptr<System> sys;
+    hGroup                  group;
+    uint64_t                key;
+  } dragSession;
+  uint64_t DragSessionKey(hGroup hg);
+  void     EndDragSession();
+
   // All the TrueType fonts in memory
   TtfFontList fonts;
 
@@ -63,6 +63,7 @@ void SolveSpaceUI::PushFromCurrentOnto(UndoStack *uk) {
     dest.thisShell = {};
     dest.runningShell = {};
     dest.displayMesh = {};
+    dest.displayMeshBvh = {};
     dest.displayOutlines = {};
 
     dest.remap = src.remap;
@@ -10,6 +10,11 @@
 
 #include <Eigen/Core>
 #include <Eigen/SparseQR>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SVD>
+
+#include <unordered_map>
+#include <unordered_set>
 
 // The solver will converge all unknowns to within this tolerance. This must
 // always be much less than LENGTH_EPS, and in practice should be much less.
@@ -17,6 +22,47 @@ const double System::CONVERGE_TOLERANCE = (LENGTH_EPS / (1e2));
 
 constexpr size_t LikelyPartialCountPerEq = 10;
 
+struct System::LinearSolver {
+  Factorization kind;
+  // The pattern that the factorizations below were analyzed for
+  bool analyzed = false;
+  int  rows = 0, nonZeros = 0;
+
+  Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>> qr;
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>                      ldlt;
+  Eigen::SimplicialLLT<Eigen::SparseMatrix<double>>                       llt;
+
+  LinearSolver(Factorization kind) : kind(kind) {}
+
+  template<class Solver>
+  static bool Solve(Solver &solver, bool analyze, const Eigen::SparseMatrix<double> &A,
+                    const Eigen::VectorXd &B, Eigen::VectorXd *X) {
+    if (analyze)
+      solver.analyzePattern(A);
+    solver.factorize(A);
+    if (solver.info() != Eigen::Success)
+      return false;
+    *X = solver.solve(B);
+    return (solver.info() == Eigen::Success);
+  }
+
+  bool Solve(const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &B, Eigen::VectorXd *X) {
+    // The product A*A^T keeps structural zeros, so this only fails to
+    // hold if the Jacobian itself was rewritten.
+    bool analyze = !analyzed || rows != A.rows() || nonZeros != A.nonZeros();
+    analyzed = true;
+    rows = A.rows();
+    nonZeros = A.nonZeros();
+
+    switch (kind) {
+    case Factorization::SPARSE_QR: return Solve(qr, analyze, A, B, X);
+    case Factorization::SIMPLICIAL_LDLT: return Solve(ldlt, analyze, A, B, X);
+    case Factorization::SIMPLICIAL_LLT: return Solve(llt, analyze, A, B, X);
+    }
+    ssassert(false, "Unexpected factorization");
+  }
+};
+
 bool System::WriteJacobian(int tag) {
   // Clear all
   mat.param.clear();
@@ -47,8 +93,12 @@ bool System::WriteJacobian(int tag) {
   }
 
   if (mat.eq.size() >= MAX_UNKNOWNS) {
+    CompileJacobian();
     return false;
   }
+  ExprDag        dag;
+  ExprDag::Scope dagScope(hashConsExprs ? &dag : NULL);
+
   std::vector<hParam> paramsUsed;
   // In some experimenting, this is almost always the right size.
   // Value is usually between 0 and 20, comes from number of constraints?
@@ -81,24 +131,65 @@ bool System::WriteJacobian(int tag) {
     paramsUsed.clear();
     mat.B.sym.push_back(f);
   }
+  exprStats = dag.stats;
+  CompileJacobian();
   return true;
 }
 
-void System::EvalJacobian() {
+void System::CompileJacobian() {
   using namespace Eigen;
-  mat.A.num.setZero();
-  mat.A.num.resize(mat.m, mat.n);
-  const int size = mat.A.sym.outerSize();
+  mat.tape.Clear();
+  mat.A.reg.clear();
+  mat.B.reg.clear();
+
+  // The residuals go first, since they're evaluated on their own in the
+  // Newton loop as well.
+  mat.B.reg.reserve(mat.B.sym.size());
+  for (Expr *e : mat.B.sym) {
+    mat.B.reg.push_back(mat.tape.Add(e));
+  }
 
+  // Both sym and num keep their entries sorted by column and then by row,
+  // so the k-th entry of one is the k-th entry of the other.
+  std::vector<Triplet<double>> pattern;
+  pattern.reserve(mat.A.sym.nonZeros());
+  mat.A.reg.reserve(mat.A.sym.nonZeros());
+  const int size = mat.A.sym.outerSize();
   for (int k = 0; k < size; k++) {
     for (SparseMatrix<Expr *>::InnerIterator it(mat.A.sym, k); it; ++it) {
-      double value = it.value()->Eval();
-      if (EXACT(value == 0.0))
-        continue;
-      mat.A.num.insert(it.row(), it.col()) = value;
+      mat.A.reg.push_back(mat.tape.Add(it.value()));
+      pattern.emplace_back(it.row(), it.col(), 0.0);
     }
   }
+  mat.A.num.resize(mat.m, mat.n);
+  mat.A.num.setFromTriplets(pattern.begin(), pattern.end());
   mat.A.num.makeCompressed();
+
+  // The sparsity pattern changed, so the factorization has to be redone
+  // from scratch.
+  if (mat.solver)
+    mat.solver->analyzed = false;
+}
+
+void System::EvalJacobian() {
+  mat.tape.Eval();
+  LoadJacobianFromTape();
+}
+
+// Fill in the numeric Jacobian from the last evaluation of the tape.
+void System::LoadJacobianFromTape() {
+  ssassert((size_t)mat.A.num.nonZeros() == mat.A.reg.size(), "Jacobian pattern changed");
+  double *values = mat.A.num.valuePtr();
+  for (size_t k = 0; k < mat.A.reg.size(); k++) {
+    values[k] = mat.tape.Value(mat.A.reg[k]);
+  }
+}
+
+void System::LoadResidualsFromTape() {
+  mat.B.num.resize(mat.m);
+  for (int i = 0; i < mat.m; i++) {
+    mat.B.num[i] = mat.tape.Value(mat.B.reg[i]);
+  }
 }
 
 bool System::IsDragged(hParam p) {
@@ -227,12 +318,17 @@ void System::SolveBySubstitution() {
 //-----------------------------------------------------------------------------
 // Calculate the rank of the Jacobian matrix
 //-----------------------------------------------------------------------------
-int System::CalculateRank() {
+int System::CalculateRank(double pivotThreshold) {
   using namespace Eigen;
   if (mat.n == 0 || mat.m == 0)
     return 0;
   SparseQR<SparseMatrix<double>, COLAMDOrdering<int>> solver;
-  solver.compute(mat.A.num);
+  if (pivotThreshold >= 0)
+    solver.setPivotThreshold(pivotThreshold);
+  // Drop the entries that happen to evaluate to zero, since the ordering
+  // (and so the rank that QR reports near its threshold) depends on them.
+  SparseMatrix<double> A = mat.A.num.pruned();
+  solver.compute(A);
   int result = solver.rank();
   return result;
 }
@@ -247,16 +343,28 @@ bool System::TestRank(int *dof) {
   return jacobianRank == mat.m;
 }
 
+// The largest 2-norm of any column of the Jacobian, which is what SparseQR
+// scales its default rank threshold by.
+double System::MaxColumnNorm() {
+  double maxNorm = 0.0;
+  for (int k = 0; k < mat.A.num.outerSize(); k++) {
+    double norm = 0.0;
+    for (Eigen::SparseMatrix<double>::InnerIterator it(mat.A.num, k); it; ++it) {
+      norm += it.value() * it.value();
+    }
+    maxNorm = std::max(maxNorm, sqrt(norm));
+  }
+  return maxNorm;
+}
+
 bool System::SolveLinearSystem(const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &B,
                                Eigen::VectorXd *X) {
   if (A.outerSize() == 0)
     return true;
-  using namespace Eigen;
-  SparseQR<SparseMatrix<double>, COLAMDOrdering<int>> solver;
-  // SimplicialLDLT<SparseMatrix<double>> solver;
-  solver.compute(A);
-  *X = solver.solve(B);
-  return (solver.info() == Success);
+  if (!mat.solver || mat.solver->kind != factorization) {
+    mat.solver = std::make_shared<LinearSolver>(factorization);
+  }
+  return mat.solver->Solve(A, B, X);
 }
 
 bool System::SolveLeastSquares() {
@@ -301,14 +409,13 @@ bool System::NewtonSolve(int tag) {
   bool converged = false;
   int i;
 
-  // Evaluate the functions at our operating point.
-  mat.B.num = Eigen::VectorXd(mat.m);
-  for (i = 0; i < mat.m; i++) {
-    mat.B.num[i] = (mat.B.sym[i])->Eval();
-  }
+  // Evaluate the functions at our operating point. The tape holds the
+  // Jacobian too, so this also evaluates that at the same point.
+  mat.tape.Eval();
+  LoadResidualsFromTape();
   do {
-    // And evaluate the Jacobian at our initial operating point.
-    EvalJacobian();
+    // And load the Jacobian at our initial operating point.
+    LoadJacobianFromTape();
 
     if (!SolveLeastSquares())
       break;
@@ -325,9 +432,8 @@ bool System::NewtonSolve(int tag) {
     }
 
     // Re-evalute the functions, since the params have just changed.
-    for (i = 0; i < mat.m; i++) {
-      mat.B.num[i] = (mat.B.sym[i])->Eval();
-    }
+    mat.tape.Eval();
+    LoadResidualsFromTape();
     // Check for convergence
     converged = true;
     for (i = 0; i < mat.m; i++) {
@@ -344,12 +450,204 @@ bool System::NewtonSolve(int tag) {
   return converged;
 }
 
+//-----------------------------------------------------------------------------
+// Split the equations and unknowns with tag 0 into subsystems that share no
+// unknowns, so that each can be solved and rank-tested on its own.
+// Equations that reference no unknown at all are gathered into one more
+// subsystem, so that they still count against the rank. If it all hangs
+// together, no subsystems are made. Returns the number of equations;
+// unknowns gets the number of parameters with tag 0.
+//-----------------------------------------------------------------------------
+int System::SplitIntoSubsystems(std::vector<std::unique_ptr<System>> *subsystems,
+                                int *unknowns) {
+  std::unordered_map<uint32_t, int> paramToIndex;
+  std::vector<Param *>              params;
+  for (Param &p : param) {
+    if (p.tag != 0)
+      continue;
+    paramToIndex[p.h.v] = (int)params.size();
+    params.push_back(&p);
+  }
+  *unknowns = (int)params.size();
+
+  // Union-find over the unknowns, joining all those used by an equation.
+  std::vector<int> parent(params.size());
+  for (size_t i = 0; i < parent.size(); i++) {
+    parent[i] = (int)i;
+  }
+  auto findRoot = [&](int i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+
+  std::vector<Equation *>          eqs;
+  std::vector<std::vector<hParam>> eqParams;
+  std::vector<int>                 eqFirstUnknown;
+  for (Equation &e : eq) {
+    if (e.tag != 0)
+      continue;
+    eqs.push_back(&e);
+    eqParams.emplace_back();
+    e.e->ParamsUsedList(&eqParams.back());
+
+    int first = -1;
+    for (hParam hp : eqParams.back()) {
+      auto it = paramToIndex.find(hp.v);
+      if (it == paramToIndex.end())
+        continue;
+      if (first < 0) {
+        first = it->second;
+      } else {
+        parent[findRoot(it->second)] = findRoot(first);
+      }
+    }
+    eqFirstUnknown.push_back(first);
+  }
+
+  // Number the subsystems in order of their first equation, so that the
+  // split is deterministic.
+  std::vector<int> rootToSubsystem(params.size(), -1);
+  std::vector<int> eqSubsystem(eqs.size());
+  int              withoutUnknowns = -1;
+  int              count = 0;
+  for (size_t i = 0; i < eqs.size(); i++) {
+    int &sub = (eqFirstUnknown[i] < 0) ? withoutUnknowns
+                                       : rootToSubsystem[findRoot(eqFirstUnknown[i])];
+    if (sub < 0)
+      sub = count++;
+    eqSubsystem[i] = sub;
+  }
+
+  subsystems->clear();
+  if (count <= 1)
+    return (int)eqs.size();
+
+  std::vector<std::vector<Param *>> subParams(count);
+  for (int i = 0; i < count; i++) {
+    subsystems->emplace_back(new System());
+    System *sub = subsystems->back().get();
+    sub->hashConsExprs = hashConsExprs;
+    sub->factorization = factorization;
+    for (hParam &hp : dragged) {
+      sub->dragged.Add(&hp);
+    }
+  }
+  for (size_t i = 0; i < params.size(); i++) {
+    int sub = rootToSubsystem[findRoot((int)i)];
+    // An unknown that no equation uses can't move, so it needs no solving.
+    if (sub >= 0)
+      subParams[sub].push_back(params[i]);
+  }
+  for (size_t i = 0; i < eqs.size(); i++) {
+    System *sub = (*subsystems)[eqSubsystem[i]].get();
+    Equation e = *eqs[i];
+    e.tag = 0;
+    sub->eq.Add(&e);
+    // The equation may also use parameters that were already solved for,
+    // and those have to be found in the subsystem too.
+    for (hParam hp : eqParams[i]) {
+      Param *p = param.FindByIdNoOops(hp);
+      if (p != NULL && p->tag != 0)
+        subParams[eqSubsystem[i]].push_back(p);
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    std::vector<Param *> &ps = subParams[i];
+    std::sort(ps.begin(), ps.end(), [](Param *a, Param *b) { return a->h.v < b->h.v; });
+    ps.erase(std::unique(ps.begin(), ps.end()), ps.end());
+    for (Param *p : ps) {
+      (*subsystems)[i]->param.Add(p);
+    }
+  }
+  return (int)eqs.size();
+}
+
+// The rank of the Jacobian of the whole system, from the Jacobians of its
+// independent parts. The pivot threshold is the one that SparseQR would have
+// picked for the whole matrix, so that the result is the same.
+int System::TestRankOfSubsystems(std::vector<std::unique_ptr<System>> *subsystems,
+                                 int equations, int unknowns) {
+  const int count = (int)subsystems->size();
+  std::vector<double> norms(count);
+#pragma omp parallel for
+  for (int i = 0; i < count; i++) {
+    System *sub = (*subsystems)[i].get();
+    sub->EvalJacobian();
+    norms[i] = sub->MaxColumnNorm();
+  }
+
+  double maxNorm = 0.0;
+  for (double norm : norms) {
+    maxNorm = std::max(maxNorm, norm);
+  }
+  if (EXACT(maxNorm == 0.0))
+    maxNorm = 1.0;
+  double threshold =
+      20 * (equations + unknowns) * maxNorm * std::numeric_limits<double>::epsilon();
+
+  std::vector<int> ranks(count);
+#pragma omp parallel for
+  for (int i = 0; i < count; i++) {
+    ranks[i] = (*subsystems)[i]->CalculateRank(threshold);
+  }
+
+  int rank = 0;
+  for (int r : ranks) {
+    rank += r;
+  }
+  return rank;
+}
+
+// Solve the subsystems from SplitIntoSubsystems in parallel, with the same
+// rank tests as Solve() does for the whole system. Returns false if any of
+// them didn't converge.
+bool System::SolveSubsystems(Group *g, std::vector<std::unique_ptr<System>> *subsystems,
+                             int equations, int unknowns, int *dof, bool *rankOk) {
+  const int count = (int)subsystems->size();
+#pragma omp parallel for
+  for (int i = 0; i < count; i++) {
+    (*subsystems)[i]->WriteJacobian(0);
+  }
+
+  auto testRank = [&]() {
+    int rank = TestRankOfSubsystems(subsystems, equations, unknowns);
+    if (dof != NULL)
+      *dof = unknowns - rank;
+    return rank == equations;
+  };
+
+  // Clear dof value in order to have indication when dof is actually not calculated
+  if (dof != NULL)
+    *dof = -1;
+  *rankOk = (!g->suppressDofCalculation && !g->allowRedundant) ? testRank() : true;
+
+  std::vector<char> converged(count);
+#pragma omp parallel for
+  for (int i = 0; i < count; i++) {
+    converged[i] = (*subsystems)[i]->NewtonSolve(0);
+  }
+  if (std::find(converged.begin(), converged.end(), false) != converged.end())
+    return false;
+
+  for (auto &sub : *subsystems) {
+    for (Param &p : sub->param) {
+      if (p.tag != 0)
+        continue;
+      param.FindById(p.h)->val = p.val;
+    }
+  }
+
+  *rankOk = (!g->suppressDofCalculation) ? testRank() : true;
+  return true;
+}
+
 void System::WriteEquationsExceptFor(hConstraint hc, Group *g) {
   // Generate all the equations from constraints in this group
-  for (auto &con : SK.constraint) {
-    Constraint *c = &con;
-    if (c->group != g->h)
-      continue;
+  for (hConstraint hci : SK.ItemsInGroup(g->h).constraint) {
+    Constraint *c = SK.GetConstraint(hci);
     if (c->h == hc)
       continue;
 
@@ -369,32 +667,115 @@ void System::WriteEquationsExceptFor(hConstraint hc, Group *g) {
     c->GenerateEquations(&eq);
   }
   // And the equations from entities
-  for (auto &ent : SK.entity) {
-    Entity *e = &ent;
-    if (e->group != g->h)
-      continue;
-
+  std::vector<Entity *> entities;
+  SK.EntitiesInGroup(g->h, &entities);
+  for (Entity *e : entities) {
     e->GenerateEquations(&eq);
   }
   // And from the groups themselves
   g->GenerateEquations(&eq);
 }
 
+//-----------------------------------------------------------------------------
+// A basis for the left null space of the Jacobian, one vector per column.
+// Each vector gives a combination of the rows that cancels out, so the rows
+// with nonzero weight are the ones that make the system redundant. From a
+// QR factorization of J^T with column pivoting, J^T P = Q [R11 R12; 0 0],
+// and the basis is P [-R11^-1 R12; I]. The columns are scaled so that their
+// largest entry is 1.
+//-----------------------------------------------------------------------------
+static Eigen::MatrixXd LeftNullSpace(const Eigen::SparseMatrix<double> &A, double pivotThreshold) {
+  using namespace Eigen;
+  SparseMatrix<double> At = A.pruned().transpose();
+  At.makeCompressed();
+  SparseQR<SparseMatrix<double>, COLAMDOrdering<int>> qr;
+  qr.setPivotThreshold(pivotThreshold);
+  qr.compute(At);
+
+  const int m = (int)A.rows();
+  const int r = (int)qr.rank();
+  const int d = m - r;
+  SparseMatrix<double> R = qr.matrixR();
+  SparseMatrix<double> R11 = R.topLeftCorner(r, r);
+  MatrixXd R12 = MatrixXd(R.block(0, r, r, d));
+
+  MatrixXd Z(m, d);
+  Z.topRows(r) = -R11.triangularView<Upper>().solve(R12);
+  Z.bottomRows(d).setIdentity();
+  MatrixXd Y = qr.colsPermutation() * Z;
+  for (int j = 0; j < d; j++) {
+    Y.col(j) /= Y.col(j).cwiseAbs().maxCoeff();
+  }
+  return Y;
+}
+
 void System::FindWhichToRemoveToFixJacobian(Group *g, List<hConstraint> *bad, bool forceDofCheck) {
   auto time = GetMilliseconds();
   g->solved.timeout = false;
   int a;
 
-  for (a = 0; a < 2; a++) {
-    for (auto &con : SK.constraint) {
+  // Write the whole system once. Removing a constraint whose equations all
+  // survive substitution takes them out as rows of the Jacobian and leaves
+  // the rest alone, since the substitutions come only from the other
+  // equations; so that fixes the rank exactly when no combination of the
+  // remaining rows cancels out: when the null space restricted to its rows
+  // still has full rank.
+  param.ClearTags();
+  eq.Clear();
+  WriteEquationsExceptFor(Constraint::NO_CONSTRAINT, g);
+  eq.ClearTags();
+
+  // It's a major speedup to solve the easy ones by substitution here,
+  // and that doesn't break anything.
+  if (!forceDofCheck) {
+    SolveBySubstitution();
+  }
+
+  if (!WriteJacobian(0))
+    return;
+  EvalJacobian();
+
+  Eigen::MatrixXd nullSpace;
+  if (mat.m > 0 && mat.n > 0) {
+    double maxNorm = MaxColumnNorm();
+    if (EXACT(maxNorm == 0.0))
+      maxNorm = 1.0;
+    double threshold = 20 * (mat.m + mat.n) * maxNorm * std::numeric_limits<double>::epsilon();
+    nullSpace = LeftNullSpace(mat.A.num, threshold);
+  } else {
+    // With no unknowns, every equation is redundant.
+    nullSpace = Eigen::MatrixXd::Identity(mat.m, mat.m);
+  }
+  const int d = (int)nullSpace.cols();
+  // Weights below this are round-off from the factorization.
+  const double tol = 1e-8;
+
+  std::unordered_map<uint32_t, std::vector<int>> rowsOfConstraint;
+  for (int i = 0; i < mat.m; i++) {
+    if (mat.eq[i]->h.isFromConstraint())
+      rowsOfConstraint[mat.eq[i]->h.constraint().v].push_back(i);
+  }
+  // But removing a constraint that was substituted also undoes its
+  // substitution, which changes the other rows; those get the system
+  // rewritten without them and their rank tested from scratch.
+  std::unordered_set<uint32_t> substituted;
+  for (Equation &e : eq) {
+    if (e.tag == EQ_SUBSTITUTED && e.h.isFromConstraint())
+      substituted.insert(e.h.constraint().v);
+  }
+
+  std::vector<hConstraint>             tested;
+  std::vector<char>                    fixed;
+  std::vector<std::unique_ptr<System>> rewritten;
+  std::vector<int>                     rewrittenIndex;
+  for (a = 0; a < 2 && !g->solved.timeout; a++) {
+    for (hConstraint hc : SK.ItemsInGroup(g->h).constraint) {
       if ((GetMilliseconds() - time) > g->solved.findToFixTimeout) {
         g->solved.timeout = true;
-        return;
+        break;
       }
 
-      Constraint *c = &con;
-      if (c->group != g->h)
-        continue;
+      Constraint *c = SK.GetConstraint(hc);
       if ((c->type == Constraint::Type::POINTS_COINCIDENT && a == 0) ||
           (c->type != Constraint::Type::POINTS_COINCIDENT && a == 1)) {
         // Do the constraints in two passes: first everything but
@@ -403,25 +784,73 @@ void System::FindWhichToRemoveToFixJacobian(Group *g, List<hConstraint> *bad, bo
         continue;
       }
 
-      param.ClearTags();
-      eq.Clear();
-      WriteEquationsExceptFor(c->h, g);
-      eq.ClearTags();
+      tested.push_back(c->h);
+      fixed.push_back(false);
+      if (substituted.count(c->h.v)) {
+        rewritten.emplace_back(new System());
+        System *sys = rewritten.back().get();
+        sys->hashConsExprs = hashConsExprs;
+        sys->factorization = factorization;
+        for (hParam &hp : dragged) {
+          sys->dragged.Add(&hp);
+        }
+        for (Param &p : param) {
+          Param np = p;
+          np.tag = 0;
+          np.substd = NULL;
+          sys->param.Add(&np);
+        }
+        sys->WriteEquationsExceptFor(c->h, g);
+        rewrittenIndex.push_back((int)fixed.size() - 1);
+        continue;
+      }
 
-      // It's a major speedup to solve the easy ones by substitution here,
-      // and that doesn't break anything.
-      if (!forceDofCheck) {
-        SolveBySubstitution();
+      auto it = rowsOfConstraint.find(c->h.v);
+      if (d == 0) {
+        // Nothing to fix; removing anything leaves it full rank.
+        fixed.back() = true;
+      } else if (it == rowsOfConstraint.end() || (int)it->second.size() < d) {
+        fixed.back() = false;
+      } else {
+        Eigen::MatrixXd rows(it->second.size(), d);
+        for (size_t k = 0; k < it->second.size(); k++) {
+          rows.row(k) = nullSpace.row(it->second[k]);
+        }
+        Eigen::JacobiSVD<Eigen::MatrixXd> svd(rows);
+        fixed.back() = (svd.singularValues().array() > tol).count() == d;
       }
+    }
+  }
 
-      WriteJacobian(0);
-      EvalJacobian();
+  // The rewritten systems are independent of each other, so test them in
+  // parallel. Those are the slow tests, so they're held to the timeout too;
+  // any left when it runs out are skipped, and not reported as fixing it.
+  const int count = (int)rewritten.size();
+  std::vector<char> skipped(count, false);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < count; i++) {
+    if ((GetMilliseconds() - time) > g->solved.findToFixTimeout) {
+      skipped[i] = true;
+      continue;
+    }
+    System *sys = rewritten[i].get();
+    sys->eq.ClearTags();
+    sys->SolveBySubstitution();
+    sys->WriteJacobian(0);
+    sys->EvalJacobian();
+    fixed[rewrittenIndex[i]] = (sys->CalculateRank() == sys->mat.m);
+  }
+  for (int i = 0; i < count; i++) {
+    if (skipped[i]) {
+      g->solved.timeout = true;
+      break;
+    }
+  }
 
-      int rank = CalculateRank();
-      if (rank == mat.m) {
-        // We fixed it by removing this constraint
-        bad->Add(&(c->h));
-      }
+  for (size_t i = 0; i < tested.size(); i++) {
+    if (fixed[i]) {
+      // We fixed it by removing this constraint
+      bad->Add(&tested[i]);
     }
   }
 }
@@ -430,7 +859,10 @@ SolveResult System::Solve(Group *g, int *rank, int *dof, List<hConstraint> *bad,
                           bool andFindFree, bool forceDofCheck) {
   WriteEquationsExceptFor(Constraint::NO_CONSTRAINT, g);
 
-  bool rankOk;
+  bool                                       rankOk;
+  int                                        equations, unknowns;
+  std::vector<std::pair<Equation *, double>> residuals;
+  subsystems.clear();
 
   /*
       int x;
@@ -485,24 +917,36 @@ SolveResult System::Solve(Group *g, int *rank, int *dof, List<hConstraint> *bad,
     alone++;
   }
 
-  // Now write the Jacobian for what's left, and do a rank test; that
-  // tells us if the system is inconsistently constrained.
-  if (!WriteJacobian(0)) {
-    return SolveResult::TOO_MANY_UNKNOWNS;
-  }
-  // Clear dof value in order to have indication when dof is actually not calculated
-  if (dof != NULL)
-    *dof = -1;
-  // We are suppressing or allowing redundant, so we no need to catch unsolveable + redundant
-  rankOk = (!g->suppressDofCalculation && !g->allowRedundant) ? TestRank(dof) : true;
+  // What's left often falls apart into pieces that share no unknowns;
+  // those are cheaper to solve separately, and can be solved in parallel.
+  equations = SplitIntoSubsystems(&subsystems, &unknowns);
+  if (subsystems.size() > 1) {
+    if (equations >= MAX_UNKNOWNS) {
+      return SolveResult::TOO_MANY_UNKNOWNS;
+    }
+    if (!SolveSubsystems(g, &subsystems, equations, unknowns, dof, &rankOk)) {
+      goto didnt_converge;
+    }
+  } else {
+    // Now write the Jacobian for what's left, and do a rank test; that
+    // tells us if the system is inconsistently constrained.
+    if (!WriteJacobian(0)) {
+      return SolveResult::TOO_MANY_UNKNOWNS;
+    }
+    // Clear dof value in order to have indication when dof is actually not calculated
+    if (dof != NULL)
+      *dof = -1;
+    // We are suppressing or allowing redundant, so we no need to catch unsolveable + redundant
+    rankOk = (!g->suppressDofCalculation && !g->allowRedundant) ? TestRank(dof) : true;
+
+    // And do the leftovers as one big system
+    if (!NewtonSolve(0)) {
+      goto didnt_converge;
+    }
 
-  // And do the leftovers as one big system
-  if (!NewtonSolve(0)) {
-    goto didnt_converge;
+    // Here we are want to calculate dof even when redundant is allowed, so just handle suppressing
+    rankOk = (!g->suppressDofCalculation) ? TestRank(dof) : true;
   }
-
-  // Here we are want to calculate dof even when redundant is allowed, so just handle suppressing
-  rankOk = (!g->suppressDofCalculation) ? TestRank(dof) : true;
   if (!rankOk) {
     if (andFindBad)
       FindWhichToRemoveToFixJacobian(g, bad, forceDofCheck);
@@ -511,30 +955,35 @@ SolveResult System::Solve(Group *g, int *rank, int *dof, List<hConstraint> *bad,
   }
   // System solved correctly, so write the new values back in to the
   // main parameter table.
-  for (auto &p : param) {
-    double val;
-    if (p.tag == VAR_SUBSTITUTED) {
-      val = p.substd->val;
-    } else {
-      val = p.val;
-    }
-    Param *pp = SK.GetParam(p.h);
-    pp->val = val;
-    pp->known = true;
-    pp->free = p.free;
-  }
+  StoreSolution();
   return rankOk ? SolveResult::OKAY : SolveResult::REDUNDANT_OKAY;
 
 didnt_converge:
   SK.constraint.ClearTags();
-  // Not using range-for here because index is used in additional ways
-  for (size_t i = 0; i < mat.eq.size(); i++) {
-    if (fabs(mat.B.num[i]) > CONVERGE_TOLERANCE || IsReasonable(mat.B.num[i])) {
+  // Gather the residuals of whichever system failed, in the order of the
+  // equations they come from.
+  if (subsystems.empty()) {
+    for (size_t i = 0; i < mat.eq.size(); i++) {
+      residuals.emplace_back(mat.eq[i], mat.B.num[i]);
+    }
+  } else {
+    for (auto &sub : subsystems) {
+      for (size_t i = 0; i < sub->mat.eq.size(); i++) {
+        residuals.emplace_back(sub->mat.eq[i], sub->mat.B.num[i]);
+      }
+    }
+    std::sort(residuals.begin(), residuals.end(),
+              [](const std::pair<Equation *, double> &a, const std::pair<Equation *, double> &b) {
+                return a.first->h.v < b.first->h.v;
+              });
+  }
+  for (const auto &r : residuals) {
+    if (fabs(r.second) > CONVERGE_TOLERANCE || IsReasonable(r.second)) {
       // This constraint is unsatisfied.
-      if (!mat.eq[i]->h.isFromConstraint())
+      if (!r.first->h.isFromConstraint())
         continue;
 
-      hConstraint hc = mat.eq[i]->h.constraint();
+      hConstraint hc = r.first->h.constraint();
       Constraint *c = SK.constraint.FindByIdNoOops(hc);
       if (!c)
         continue;
@@ -550,6 +999,67 @@ didnt_converge:
   return rankOk ? SolveResult::DIDNT_CONVERGE : SolveResult::REDUNDANT_DIDNT_CONVERGE;
 }
 
+void System::StoreSolution() {
+  for (auto &p : param) {
+    double val;
+    if (p.tag == VAR_SUBSTITUTED) {
+      val = p.substd->val;
+    } else {
+      val = p.val;
+    }
+    Param *pp = SK.GetParam(p.h);
+    pp->val = val;
+    pp->known = true;
+    pp->free = p.free;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Solve the system again when only the values of the params have changed
+// since the last Solve(), e.g. while something is being dragged. This keeps
+// the equations, the substitutions and the compiled Jacobian, and just runs
+// Newton from where the unknowns are in the sketch now. Params that were
+// solved alone keep their last solution, since nothing else can move them.
+// Returns false if that doesn't converge; the caller should then solve
+// from scratch, which also finds the constraints to blame.
+//-----------------------------------------------------------------------------
+bool System::SolveAgain() {
+  for (Param &p : param) {
+    if (p.tag == 0)
+      p.val = SK.GetParam(p.h)->val;
+  }
+
+  if (subsystems.empty()) {
+    if (!NewtonSolve(0))
+      return false;
+  } else {
+    const int count = (int)subsystems.size();
+    for (auto &sub : subsystems) {
+      for (Param &p : sub->param) {
+        if (p.tag == 0)
+          p.val = param.FindById(p.h)->val;
+      }
+    }
+    std::vector<char> converged(count);
+#pragma omp parallel for
+    for (int i = 0; i < count; i++) {
+      converged[i] = subsystems[i]->NewtonSolve(0);
+    }
+    if (std::find(converged.begin(), converged.end(), false) != converged.end())
+      return false;
+
+    for (auto &sub : subsystems) {
+      for (Param &p : sub->param) {
+        if (p.tag != 0)
+          continue;
+        param.FindById(p.h)->val = p.val;
+      }
+    }
+  }
+  StoreSolution();
+  return true;
+}
+
 SolveResult System::SolveRank(Group *g, int *rank, int *dof, List<hConstraint> *bad,
                               bool andFindBad, bool andFindFree) {
   WriteEquationsExceptFor(Constraint::NO_CONSTRAINT, g);
@@ -585,6 +1095,10 @@ void System::Clear() {
   dragged.Clear();
   mat.A.num.setZero();
   mat.A.sym.setZero();
+  mat.A.reg.clear();
+  mat.B.reg.clear();
+  mat.tape.Clear();
+  subsystems.clear();
 }
 
 void System::MarkParamsFree(bool find) {
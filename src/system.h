@@ -21,6 +21,14 @@ class System {
     EQ_SUBSTITUTED = 20000
   };
 
+  // The sparse factorization used for the least-squares step. QR copes
+  // with the rank-deficient systems that redundant constraints produce; the
+  // Cholesky variants are faster but need A*A^T to be positive definite.
+  enum class Factorization : uint32_t { SPARSE_QR = 0, SIMPLICIAL_LDLT = 1, SIMPLICIAL_LLT = 2 };
+  Factorization factorization = Factorization::SPARSE_QR;
+
+  struct LinearSolver;
+
   // The system Jacobian matrix
   struct {
     // The corresponding equation for each row
@@ -34,7 +42,12 @@ class System {
     struct {
       // This only observes the Expr - does not own them!
       Eigen::SparseMatrix<Expr *> sym;
+      // Has an entry for every entry of sym, even where it evaluates to
+      // zero, so that its sparsity pattern stays fixed until the next
+      // WriteJacobian.
       Eigen::SparseMatrix<double> num;
+      // The tape register of each entry of sym, in storage order
+      std::vector<uint32_t> reg;
     } A;
 
     Eigen::VectorXd scale;
@@ -42,20 +55,43 @@ class System {
 
     struct {
       // This only observes the Expr - does not own them!
-      std::vector<Expr *> sym;
-      Eigen::VectorXd     num;
+      std::vector<Expr *>   sym;
+      std::vector<uint32_t> reg;
+      Eigen::VectorXd       num;
     } B;
+
+    // A.sym and B.sym compiled together, so that shared subexpressions
+    // are evaluated once per Newton iteration.
+    ExprTape tape;
+
+    // Factorization of A*A^T; its ordering and symbolic analysis are kept
+    // across Newton iterations, and redone only after WriteJacobian.
+    std::shared_ptr<LinearSolver> solver;
   } mat;
 
+  // Hash-cons the expressions that WriteJacobian builds, so that the
+  // residuals and their partials share their common subtrees; the stats
+  // describe the last Jacobian written.
+  bool           hashConsExprs = true;
+  ExprDag::Stats exprStats     = {};
+
+  // The independent parts that the last Solve() split the system into, if
+  // it fell apart; each holds its own equations and compiled Jacobian.
+  std::vector<std::unique_ptr<System>> subsystems;
+
   static const double CONVERGE_TOLERANCE;
-  int                 CalculateRank ();
+  int                 CalculateRank (double pivotThreshold = -1);
   bool                TestRank (int *dof = NULL);
-  static bool SolveLinearSystem (const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &B,
-                                 Eigen::VectorXd *X);
+  double              MaxColumnNorm ();
+  bool SolveLinearSystem (const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &B,
+                          Eigen::VectorXd *X);
   bool        SolveLeastSquares ();
 
   bool WriteJacobian (int tag);
+  void CompileJacobian ();
   void EvalJacobian ();
+  void LoadJacobianFromTape ();
+  void LoadResidualsFromTape ();
 
   void WriteEquationsExceptFor (hConstraint hc, Group *g);
   void FindWhichToRemoveToFixJacobian (Group *g, List<hConstraint> *bad, bool forceDofCheck);
@@ -65,14 +101,25 @@ class System {
 
   bool NewtonSolve (int tag);
 
+  int  SplitIntoSubsystems (std::vector<std::unique_ptr<System>> *subsystems, int *unknowns);
+  int  TestRankOfSubsystems (std::vector<std::unique_ptr<System>> *subsystems, int equations,
+                             int unknowns);
+  bool SolveSubsystems (Group *g, std::vector<std::unique_ptr<System>> *subsystems, int equations,
+                        int unknowns, int *dof, bool *rankOk);
+
   void MarkParamsFree (bool findFree);
 
   SolveResult Solve (Group *g, int *rank = NULL, int *dof = NULL, List<hConstraint> *bad = NULL,
                      bool andFindBad = false, bool andFindFree = false, bool forceDofCheck = false);
 
+  bool SolveAgain ();
+  void StoreSolution ();
+
   SolveResult SolveRank (Group *g, int *rank = NULL, int *dof = NULL, List<hConstraint> *bad = NULL,
                          bool andFindBad = false, bool andFindFree = false);
 
+  ~System () { Clear (); }
+
   void   Clear ();
   Param *GetLastParamSubstitution (Param *p);
   void   SubstituteParamsByLast (Expr *e);
@@ -31,3 +31,20 @@ TEST_CASE(free_in_3d_migrate_from_v22) {
   CHECK_LOAD("free_in_3d_v22.slvs");
   CHECK_SAVE("free_in_3d.slvs");
 }
+
+// Two equal distances to the same point from two points made coincident;
+// removing any one of the three constraints fixes the rank, and that has to
+// hold whether or not the coincidence was solved by substitution.
+TEST_CASE(redundant_finds_all) {
+  CHECK_LOAD("redundant.slvs");
+  Group *g = SK.GetGroup(SS.GW.activeGroup);
+  for (int substituted = 0; substituted < 2; substituted++) {
+    g->dofCheckOk = (substituted != 0);
+    SS.GenerateAll(SolveSpaceUI::Generate::ALL);
+    CHECK_TRUE(g->solved.how == SolveResult::REDUNDANT_OKAY);
+    CHECK_TRUE(g->solved.remove.n == 3);
+    CHECK_TRUE(g->solved.remove[0].v == 1);
+    CHECK_TRUE(g->solved.remove[1].v == 2);
+    CHECK_TRUE(g->solved.remove[2].v == 3);
+  }
+}
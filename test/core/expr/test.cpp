@@ -102,3 +102,85 @@ TEST_CASE(errors) {
   CHECK_PARSE_ERR("( 2 + 2", "Expected ')'");
   CHECK_PARSE_ERR("(", "Expected ')'");
 }
+
+static Expr *ParamPtr(Param *p) {
+  Expr *e = Expr::AllocExpr();
+  e->op = Expr::Op::PARAM_PTR;
+  e->parp = p;
+  return e;
+}
+
+TEST_CASE(tape_matches_tree) {
+  Param p[2] = {};
+  p[0].h.v = 1;
+  p[1].h.v = 2;
+  Expr *x = ParamPtr(&p[0]);
+  Expr *y = ParamPtr(&p[1]);
+
+  // Shares the subtree (x * y) several times, and uses every operation.
+  Expr *xy = x->Times(y);
+  Expr *f = (xy->Sin())->Plus(xy->Square())->Minus((y->Sqrt())->Div(x->Cos()));
+  Expr *g = ((x->Div(Expr::From(4.0)))->ASin())
+                ->Plus(((xy->Negate())->Times(y)->Div(Expr::From(2.0)))->ACos());
+
+  std::vector<Expr *> exprs = {f, g};
+  for (Expr *e : {f, g}) {
+    exprs.push_back(e->PartialWrt(p[0].h)->FoldConstants());
+    exprs.push_back(e->PartialWrt(p[1].h)->FoldConstants());
+  }
+
+  ExprTape tape;
+  std::vector<uint32_t> regs;
+  for (Expr *e : exprs) {
+    regs.push_back(tape.Add(e));
+  }
+  // The repeated (x * y) and its derivatives must have been shared.
+  int treeNodes = 0;
+  for (Expr *e : exprs) {
+    treeNodes += e->Nodes();
+  }
+  CHECK_TRUE((int)tape.Size() < treeNodes);
+
+  for (double vx : {0.1, 0.7, 1.3}) {
+    for (double vy : {0.2, 0.5, 0.9}) {
+      p[0].val = vx;
+      p[1].val = vy;
+      tape.Eval();
+      for (size_t i = 0; i < exprs.size(); i++) {
+        CHECK_EQ_EPS(tape.Value(regs[i]), exprs[i]->Eval());
+      }
+    }
+  }
+}
+
+TEST_CASE(hash_consing) {
+  Param p[2] = {};
+  p[0].h.v = 1;
+  p[1].h.v = 2;
+  p[0].val = 0.4;
+  p[1].val = 1.7;
+
+  ExprDag dag;
+  Expr *f, *g, *dfx, *dgx;
+  {
+    ExprDag::Scope scope(&dag);
+    Expr *x = ParamPtr(&p[0]);
+    Expr *y = ParamPtr(&p[1]);
+    // Built twice, but the table should make them the same node.
+    f = (x->Times(y))->Plus((x->Times(y))->Sin());
+    g = (x->Times(y))->Plus((x->Times(y))->Sin());
+    dfx = f->PartialWrt(p[0].h)->FoldConstants();
+    dgx = g->PartialWrt(p[0].h)->FoldConstants();
+  }
+  CHECK_TRUE(f == g);
+  CHECK_TRUE(dfx == dgx);
+  CHECK_TRUE(f->a == f->b->a);
+  CHECK_TRUE(dag.stats.created < dag.stats.requested);
+
+  // And the result still means the same thing as a tree would.
+  Expr *x = ParamPtr(&p[0]);
+  Expr *y = ParamPtr(&p[1]);
+  Expr *t = (x->Times(y))->Plus((x->Times(y))->Sin());
+  CHECK_EQ_EPS(f->Eval(), t->Eval());
+  CHECK_EQ_EPS(dfx->Eval(), t->PartialWrt(p[0].h)->Eval());
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 Tara Harris <3769985+realtaraharris@users.noreply.github.com>
+ * All rights reserved. Distributed under the terms of the GPLv3 and MIT licenses.
+ */
+
+#include "harness.h"
+
+TEST_CASE(sedgelist_assemble_backwards_edges) {
+  SEdgeList el = {};
+  el.AddEdge(Vector(0.0, 0.0, 0.0), Vector(1.0, 0.0, 0.0));
+  el.AddEdge(Vector(0.0, 1.0, 0.0), Vector(0.0, 0.0, 0.0));
+  // Backwards; the contour runs from (1, 1) to (0, 1).
+  el.AddEdge(Vector(0.0, 1.0, 0.0), Vector(1.0, 1.0, 0.0));
+  el.AddEdge(Vector(1.0, 0.0, 0.0), Vector(1.0, 1.0, 0.0));
+
+  static const double expected[][2] = {
+      {0.0, 0.0}, {1.0, 0.0}, {1.0, 1.0}, {0.0, 1.0}, {0.0, 0.0},
+  };
+  SPolygon sp = {};
+  SEdge errorAt = {};
+  CHECK_TRUE(el.AssemblePolygon(&sp, &errorAt));
+  CHECK_TRUE(sp.l.n == 1);
+  CHECK_TRUE(sp.l[0].l.n == 5);
+  for (int i = 0; i < sp.l[0].l.n; i++) {
+    CHECK_EQ_EPS(sp.l[0].l[i].p.x, expected[i][0]);
+    CHECK_EQ_EPS(sp.l[0].l[i].p.y, expected[i][1]);
+  }
+  sp.Clear();
+  el.Clear();
+}
+
+TEST_CASE(sedgelist_assemble_keep_dir) {
+  // A square, and a triangle that shares its corner at (1, 0). The
+  // triangle's edge into that corner comes first, so it's taken backwards
+  // unless keepDir.
+  SEdgeList el = {};
+  el.AddEdge(Vector(0.0, 0.0, 0.0), Vector(1.0, 0.0, 0.0));
+  el.AddEdge(Vector(2.0, 1.0, 0.0), Vector(1.0, 0.0, 0.0));
+  el.AddEdge(Vector(1.0, 0.0, 0.0), Vector(1.0, 1.0, 0.0));
+  el.AddEdge(Vector(1.0, 1.0, 0.0), Vector(0.0, 1.0, 0.0));
+  el.AddEdge(Vector(0.0, 1.0, 0.0), Vector(0.0, 0.0, 0.0));
+  el.AddEdge(Vector(1.0, 0.0, 0.0), Vector(2.0, 0.0, 0.0));
+  el.AddEdge(Vector(2.0, 0.0, 0.0), Vector(2.0, 1.0, 0.0));
+
+  static const double kept[][2] = {
+      {0.0, 0.0}, {1.0, 0.0}, {1.0, 1.0}, {0.0, 1.0}, {0.0, 0.0},
+      {2.0, 1.0}, {1.0, 0.0}, {2.0, 0.0}, {2.0, 1.0},
+  };
+  SPolygon sp = {};
+  SEdge errorAt = {};
+  CHECK_TRUE(el.AssemblePolygon(&sp, &errorAt, /*keepDir=*/true));
+  CHECK_TRUE(sp.l.n == 2);
+  CHECK_TRUE(sp.l[0].l.n == 5);
+  CHECK_TRUE(sp.l[1].l.n == 4);
+  for (int i = 0; i < 9; i++) {
+    SContour *sc = &sp.l[i < 5 ? 0 : 1];
+    Vector p = sc->l[i < 5 ? i : i - 5].p;
+    CHECK_EQ_EPS(p.x, kept[i][0]);
+    CHECK_EQ_EPS(p.y, kept[i][1]);
+  }
+  sp.Clear();
+
+  static const double either[][2] = {
+      {0.0, 0.0}, {1.0, 0.0}, {2.0, 1.0}, {2.0, 0.0},
+      {1.0, 0.0}, {1.0, 1.0}, {0.0, 1.0}, {0.0, 0.0},
+  };
+  el.l.ClearTags();
+  CHECK_TRUE(el.AssemblePolygon(&sp, &errorAt, /*keepDir=*/false));
+  CHECK_TRUE(sp.l.n == 1);
+  CHECK_TRUE(sp.l[0].l.n == 8);
+  for (int i = 0; i < sp.l[0].l.n; i++) {
+    CHECK_EQ_EPS(sp.l[0].l[i].p.x, either[i][0]);
+    CHECK_EQ_EPS(sp.l[0].l[i].p.y, either[i][1]);
+  }
+  sp.Clear();
+  el.Clear();
+}
+
+TEST_CASE(sedgelist_assemble_jittered_ends) {
+  // Endpoints that are Equal() but not exact, some on either side of a
+  // cell boundary at zero.
+  SEdgeList el = {};
+  el.AddEdge(Vector(0.0, 0.0, 0.0), Vector(1.0, 0.0, 0.0));
+  el.AddEdge(Vector(1.0 + 4e-7, -3e-7, 0.0), Vector(1.0, 1.0, 0.0));
+  el.AddEdge(Vector(1.0, 1.0 + 5e-7, 0.0), Vector(0.0, 1.0, 0.0));
+  el.AddEdge(Vector(-4e-7, 1.0, 0.0), Vector(3e-7, -2e-7, 0.0));
+
+  SPolygon sp = {};
+  SEdge errorAt = {};
+  CHECK_TRUE(el.AssemblePolygon(&sp, &errorAt));
+  CHECK_TRUE(sp.l.n == 1);
+  CHECK_TRUE(sp.l[0].l.n == 5);
+  // The contour closes on the last edge's own end, not on the first point.
+  CHECK_TRUE(sp.l[0].l[4].p.x == 3e-7);
+  CHECK_TRUE(sp.l[0].l[4].p.y == -2e-7);
+  sp.Clear();
+
+  // But not once they're further apart than LENGTH_EPS.
+  el.l.ClearTags();
+  el.l[3].b = Vector(2e-6, 0.0, 0.0);
+  CHECK_FALSE(el.AssemblePolygon(&sp, &errorAt));
+  CHECK_TRUE(errorAt.a.Equals(Vector(0.0, 0.0, 0.0)));
+  CHECK_TRUE(errorAt.b.Equals(Vector(2e-6, 0.0, 0.0)));
+  sp.Clear();
+  el.Clear();
+}
+
+TEST_CASE(sedgelist_assemble_open_contour) {
+  SEdgeList el = {};
+  el.AddEdge(Vector(0.0, 0.0, 0.0), Vector(1.0, 0.0, 0.0));
+  el.AddEdge(Vector(1.0, 0.0, 0.0), Vector(1.0, 1.0, 0.0));
+  el.AddEdge(Vector(1.0, 1.0, 0.0), Vector(0.0, 1.0, 0.0));
+
+  SPolygon sp = {};
+  SEdge errorAt = {};
+  CHECK_FALSE(el.AssemblePolygon(&sp, &errorAt));
+  CHECK_TRUE(sp.l.n == 1);
+  CHECK_TRUE(sp.l[0].l.n == 4);
+  // errorAt runs from where the contour started to where it got stuck.
+  CHECK_EQ_EPS(errorAt.a.x, 0.0);
+  CHECK_EQ_EPS(errorAt.a.y, 0.0);
+  CHECK_EQ_EPS(errorAt.b.x, 0.0);
+  CHECK_EQ_EPS(errorAt.b.y, 1.0);
+  sp.Clear();
+  el.Clear();
+}
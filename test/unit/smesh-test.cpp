@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Tara Harris <3769985+realtaraharris@users.noreply.github.com>
+ * All rights reserved. Distributed under the terms of the GPLv3 and MIT licenses.
+ */
+
+#include "harness.h"
+
+TEST_CASE(smesh_first_intersection_with_bvh) {
+  // Look straight down z, with a screen point at the same x and y in the
+  // model, and the ray's t equal to z.
+  SS.usePerspectiveProj = false;
+  SS.GW.offset = Vector(0.0, 0.0, 0.0);
+  SS.GW.scale = 1.0;
+  SS.GW.projRight = Vector(1.0, 0.0, 0.0);
+  SS.GW.projUp = Vector(0.0, 1.0, 0.0);
+
+  const int size = 8;
+  SMesh m = {};
+  STriMeta meta = {};
+  // In front of everything, but not a face; so never picked.
+  meta.face = 0;
+  m.AddTriangle(meta, Vector(-1.0, -1.0, 2.0), Vector(3 * size, -1.0, 2.0),
+                Vector(-1.0, 3 * size, 2.0));
+  // A grid of squares at z = 0, each split along its diagonal; then the
+  // same again, coplanar and so tied with the first; then the left half
+  // again at z = 1, in front of both.
+  for (int layer = 0; layer < 3; layer++) {
+    double z = (layer == 2) ? 1.0 : 0.0;
+    for (int j = 0; j < size; j++) {
+      for (int i = 0; i < (layer == 2 ? size / 2 : size); i++) {
+        Vector a = Vector(i, j, z), b = Vector(i + 1, j, z), c = Vector(i + 1, j + 1, z),
+               d = Vector(i, j + 1, z);
+        meta.face = 1000 * layer + 2 * (size * j + i) + 1;
+        m.AddTriangle(meta, a, b, c);
+        meta.face++;
+        m.AddTriangle(meta, a, c, d);
+      }
+    }
+  }
+
+  STriangleBvh bvh;
+  bvh.Build(&m);
+  CHECK_FALSE(bvh.IsEmpty());
+
+  static const double fracs[][2] = {{0.2, 0.3}, {0.6, 0.3}, {0.9, 0.5}, {0.4, 0.7}, {0.1, 0.9}};
+  for (int j = 0; j < size; j++) {
+    for (int i = 0; i < size; i++) {
+      for (const auto &f : fracs) {
+        double x = i + f[0], y = j + f[1];
+        bool below = f[0] > f[1];
+        uint32_t face = 2 * (size * j + i) + (below ? 1 : 2);
+        if (i < size / 2) {
+          face += 2000;
+        }
+
+        Point2d mp = Point2d::From(x, y);
+        CHECK_TRUE(m.FirstIntersectionWith(mp) == face);
+        CHECK_TRUE(m.FirstIntersectionWith(mp, &bvh) == face);
+
+        // Of the two tied layers, the first one added wins.
+        if (i >= size / 2) {
+          double t;
+          int at = bvh.Raycast(&m, Vector(x, y, 0.0), Vector(0.0, 0.0, 1.0), true, &t);
+          CHECK_TRUE(at == 1 + 2 * (size * j + i) + (below ? 0 : 1));
+          CHECK_EQ_EPS(t, 0.0);
+        }
+      }
+    }
+  }
+
+  bvh.Clear();
+  m.Clear();
+}
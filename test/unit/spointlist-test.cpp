@@ -0,0 +1,79 @@
+/*
+ * Copyright 2024 Tara Harris <3769985+realtaraharris@users.noreply.github.com>
+ * All rights reserved. Distributed under the terms of the GPLv3 and MIT licenses.
+ */
+
+#include "harness.h"
+
+TEST_CASE(spointlist_index_for_point) {
+  // Enough points that lookups go through the hash, with the first ones on
+  // either side of a cell boundary at zero.
+  const int n = 2 * SPointList::INDEX_MIN;
+  SPointList spl = {};
+  for (int i = 0; i < n; i++) {
+    CHECK_TRUE(spl.IndexForPoint(Vector(i, 0.0, 0.0)) == -1);
+    spl.Add(Vector(i, 0.0, 0.0));
+    CHECK_TRUE(spl.IndexForPoint(Vector(i, 0.0, 0.0)) == i);
+  }
+  for (int i = 0; i < n; i++) {
+    CHECK_TRUE(spl.IndexForPoint(Vector(i - 5e-7, 3e-7, 0.0)) == i);
+    CHECK_TRUE(spl.IndexForPoint(Vector(i + 5e-7, -3e-7, 0.0)) == i);
+  }
+  CHECK_FALSE(spl.ContainsPoint(Vector(0.0, 2e-6, 0.0)));
+  CHECK_FALSE(spl.ContainsPoint(Vector(0.5, 0.0, 0.0)));
+
+  // A point that's Equal() to an earlier one doesn't hide it.
+  spl.Add(Vector(3.0 + 4e-7, 0.0, 0.0));
+  CHECK_TRUE(spl.IndexForPoint(Vector(3.0, 0.0, 0.0)) == 3);
+  spl.Clear();
+}
+
+TEST_CASE(spointlist_increment_tag_for) {
+  const int n = 2 * SPointList::INDEX_MIN;
+  SPointList spl = {};
+  for (int i = 0; i < n; i++) {
+    spl.IncrementTagFor(Vector(i, 0.0, 0.0));
+  }
+  for (int i = 0; i < n; i++) {
+    spl.IncrementTagFor(Vector(i + 3e-7, 0.0, 0.0));
+  }
+  spl.IncrementTagFor(Vector(0.0, -3e-7, 0.0));
+  CHECK_TRUE(spl.l.n == n);
+  CHECK_TRUE(spl.l[0].tag == 3);
+  for (int i = 1; i < n; i++) {
+    CHECK_TRUE(spl.l[i].tag == 2);
+  }
+  spl.Clear();
+}
+
+TEST_CASE(spointlist_remove_tagged_then_add) {
+  const int n = 4 * SPointList::INDEX_MIN;
+  SPointList spl = {};
+  for (int i = 0; i < n; i++) {
+    spl.Add(Vector(i, 0.0, 0.0));
+  }
+  CHECK_TRUE(spl.IndexForPoint(Vector(n - 1, 0.0, 0.0)) == n - 1);
+
+  // Drop every fourth point, and add others before the next lookup; so the
+  // list is still long enough to hash, and no shorter than it was.
+  spl.l.ClearTags();
+  for (int i = 0; i < n; i += 4) {
+    spl.l[i].tag = 1;
+  }
+  spl.RemoveTagged();
+  for (int i = 0; i < n; i++) {
+    spl.Add(Vector(i, 1.0, 0.0));
+  }
+  CHECK_TRUE(spl.l.n == n - n / 4 + n);
+
+  for (int i = 0; i < n; i++) {
+    int at = spl.IndexForPoint(Vector(i, 0.0, 0.0));
+    if (i % 4 == 0) {
+      CHECK_TRUE(at == -1);
+    } else {
+      CHECK_TRUE(at == i - (i / 4 + 1));
+    }
+    CHECK_TRUE(spl.IndexForPoint(Vector(i, 1.0, 0.0)) == n - n / 4 + i);
+  }
+  spl.Clear();
+}
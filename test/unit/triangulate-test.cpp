@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024 Tara Harris <3769985+realtaraharris@users.noreply.github.com>
+ * All rights reserved. Distributed under the terms of the GPLv3 and MIT licenses.
+ */
+
+#include "harness.h"
+
+static void UvTriangulate(SSurface *srf, const double (*pts)[2], int npts, SMesh *m) {
+  SContour sc = {};
+  for (int i = 0; i < npts; i++) {
+    sc.AddPoint(Vector(pts[i][0], pts[i][1], 0.0));
+  }
+  sc.UvTriangulateInto(m, srf);
+  sc.l.Clear();
+}
+
+TEST_CASE(triangulate_bridged_contour) {
+  // A clockwise square with a square hole, bridged from (0, 0) to
+  // (0.25, 0.25); both ends of the bridge appear twice in the contour.
+  static const double pts[][2] = {
+      {0.0, 0.0},   {0.25, 0.25}, {0.75, 0.25}, {0.75, 0.75}, {0.25, 0.75},
+      {0.25, 0.25}, {0.0, 0.0},   {0.0, 1.0},   {1.0, 1.0},   {1.0, 0.0},
+  };
+  // Each triangle is {a.x, a.y, b.x, b.y, c.x, c.y}, in uv.
+  static const double expected[][6] = {
+      {1.0, 0.0, 0.0, 0.0, 0.25, 0.25},   {1.0, 0.0, 0.25, 0.25, 0.75, 0.25},
+      {1.0, 1.0, 1.0, 0.0, 0.75, 0.25},   {1.0, 1.0, 0.75, 0.25, 0.75, 0.75},
+      {0.0, 1.0, 1.0, 1.0, 0.75, 0.75},   {0.0, 1.0, 0.75, 0.75, 0.25, 0.75},
+      {0.0, 0.0, 0.0, 1.0, 0.25, 0.75},   {0.0, 0.0, 0.25, 0.75, 0.25, 0.25},
+  };
+  SSurface srf = SSurface::FromPlane(Vector(0.0, 0.0, 0.0), Vector(1.0, 0.0, 0.0),
+                                     Vector(0.0, 1.0, 0.0));
+  SMesh m = {};
+  UvTriangulate(&srf, pts, 10, &m);
+
+  CHECK_TRUE(m.l.n == 8);
+  for (int i = 0; i < m.l.n; i++) {
+    STriangle *tr = &m.l[i];
+    CHECK_EQ_EPS(tr->a.x, expected[i][0]);
+    CHECK_EQ_EPS(tr->a.y, expected[i][1]);
+    CHECK_EQ_EPS(tr->b.x, expected[i][2]);
+    CHECK_EQ_EPS(tr->b.y, expected[i][3]);
+    CHECK_EQ_EPS(tr->c.x, expected[i][4]);
+    CHECK_EQ_EPS(tr->c.y, expected[i][5]);
+  }
+  m.Clear();
+}
+
+TEST_CASE(triangulate_curved_contour) {
+  // A quarter cylinder, curved in u and straight in v. The ears are picked
+  // by chord tolerance, so this differs from the same contour on a plane.
+  SS.exportMode = false;
+  SS.chordTolCalculated = 0.01;
+
+  static const double pts[][2] = {
+      {0.0, 0.0}, {0.0, 1.0}, {0.3, 0.6}, {0.6, 0.9},
+      {1.0, 1.0}, {0.9, 0.5}, {1.0, 0.0}, {0.4, 0.2},
+  };
+  static const double expected[][6] = {
+      {0.0, 0.0, 0.0, 1.0, 0.3, 0.6}, {0.4, 0.2, 0.0, 0.0, 0.3, 0.6},
+      {0.4, 0.2, 0.3, 0.6, 0.6, 0.9}, {0.6, 0.9, 1.0, 1.0, 0.9, 0.5},
+      {1.0, 0.0, 0.4, 0.2, 0.6, 0.9}, {1.0, 0.0, 0.6, 0.9, 0.9, 0.5},
+  };
+  SBezier sb = SBezier::From(Vector(1.0, 0.0, 0.0), Vector(1.0, 1.0, 0.0), Vector(0.0, 1.0, 0.0));
+  sb.weight[1] = sqrt(0.5);
+  SSurface srf = SSurface::FromExtrusionOf(&sb, Vector(0.0, 0.0, 0.0), Vector(0.0, 0.0, 2.0));
+  SMesh m = {};
+  UvTriangulate(&srf, pts, 8, &m);
+
+  CHECK_TRUE(m.l.n == 6);
+  for (int i = 0; i < m.l.n; i++) {
+    STriangle *tr = &m.l[i];
+    CHECK_EQ_EPS(tr->a.x, expected[i][0]);
+    CHECK_EQ_EPS(tr->a.y, expected[i][1]);
+    CHECK_EQ_EPS(tr->b.x, expected[i][2]);
+    CHECK_EQ_EPS(tr->b.y, expected[i][3]);
+    CHECK_EQ_EPS(tr->c.x, expected[i][4]);
+    CHECK_EQ_EPS(tr->c.y, expected[i][5]);
+  }
+  m.Clear();
+}